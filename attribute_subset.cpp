@@ -31,18 +31,10 @@ point_set_t* attribute_subset(point_set_t* skyline, point_set_t* S_output, int f
             int index = distribution(generator);
             selected_dimensions.insert(*next(set_final_dimensions.begin(), index));
         }
-        std::vector<int> dimension_indices(selected_dimensions.begin(), selected_dimensions.end());
-        // construct a new subset S_hat based on S with d_hat_2 dimension
-        point_set_t* S_hat = alloc_point_set(skyline->numberOfPoints);
-        for (int j = 0; j < skyline->numberOfPoints; ++j){
-            S_hat->points[j] = alloc_point(d_hat_2);
-            S_hat->points[j]->id = skyline->points[j]->id;
-            for (int p = 0; p < d_hat_2; ++p){
-                S_hat->points[j]->coord[p] = skyline->points[j]->coord[dimension_indices[p]];
-            }
-        }
-        // take the skyline of the newly constructed dataset S_hat
-        point_set_t* skyline_S_hat = skyline_point(S_hat);
+        // view the skyline projected onto the d_hat_2 selected dimensions
+        projection_t* S_hat = alloc_projection(skyline, selected_dimensions);
+        // take the skyline of the projected dataset S_hat
+        point_set_t* skyline_S_hat = subspace_skyline(S_hat);
         // Sphere
         point_set_t* S = sphereWSImpLP(skyline_S_hat, k);
         // take the union of S_output and S
@@ -77,7 +69,8 @@ point_set_t* attribute_subset(point_set_t* skyline, point_set_t* S_output, int f
             }
         }
         release_point_set(S, false);
-        release_point_set(S_hat, true);
+        release_point_set(skyline_S_hat, true);
+        release_projection(S_hat);
     }
     printf("number of rounds: %d\n", num_rounds);
     if (S_output->numberOfPoints > K){
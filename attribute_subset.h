@@ -1,5 +1,6 @@
 #include "other/data_utility.h"
 #include "other/sphere.h"
+#include "other/skyline_cache.h"
 #include <iostream>
 #include <chrono>
 #include <random>
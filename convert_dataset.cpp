@@ -0,0 +1,24 @@
+#include "other/data_utility.h"
+#include "other/operation.h"
+#include "other/read_write.h"
+
+#include <cstdio>
+
+using namespace std;
+
+
+// convert a dataset in the text format into the binary dataset format,
+// e.g. ./convert_dataset car.txt car.bin
+int main(int argc, char *argv[]){
+    if (argc != 3) {
+        printf("Usage: %s <input text dataset> <output binary dataset>\n", argv[0]);
+        return 1;
+    }
+
+    point_set_t* P = read_points(argv[1]);
+    write_points_binary(P, argv[2]);
+    printf("Converted %s to %s: %d points, %d dimensions\n", argv[1], argv[2], P->numberOfPoints, P->numberOfPoints > 0 ? P->points[0]->dim : 0);
+
+    release_point_set(P, true);
+    return 0;
+}
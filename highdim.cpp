@@ -33,7 +33,7 @@ highdim_output* interactive_highdim(point_set_t* P_raw, point_set_t* skyline, in
         const char* dir = std::getenv("DATA_DIR");
         std::string base = (dir && *dir) ? std::string(dir) : std::string("/data");
         if (!base.empty() && base.back() == '/') base.pop_back();
-        const char* sid = std::getenv("SESSION_ID");
+        const char* sid = session_name();
         std::string sessionId = sid ? std::string(sid) : std::string("default");
         std::string folder = base + "/sessions";
         mkdir(folder.c_str(), 0755);
@@ -62,8 +62,20 @@ highdim_output* interactive_highdim(point_set_t* P_raw, point_set_t* skyline, in
 
     int stop_phase = 0; // 0 means not stopped early; 1/2 indicate stopping phase
 
+    // end the run without a recommendation; the caller reports the error, as the process may serve other sessions
+    auto failed = [&](const std::string& error) {
+        printf("%s\n", error.c_str());
+        highdim_output* output = new highdim_output;
+        output->S = alloc_point_set(0);
+        output->error = error;
+        output->time_12 = time_12;
+        output->time_3 = 0.0;
+        return output;
+    };
+
     // phase 1: narrow down the dimensions
     printf("Phase 1: Initializing dimension selection...\n");
+    session_phase(1);
 	// store the dimensions if the user is interested in at least one in the set
 	std::set<int> selected_dimensions;
     for (int i = 0; i < d; ++i) selected_dimensions.insert(i); // initial all dimensions
@@ -101,14 +113,14 @@ highdim_output* interactive_highdim(point_set_t* P_raw, point_set_t* skyline, in
 	}
 	// phase 2: narrow down the at most d_hat*d' dimensions further
     printf("Phase 2: Refining dimension selection...\n");
+    session_phase(2);
 	// apply the Generalized_binary-splitting_algorithm
 	// store the dimensions the user is interested in
 	set<int> final_dimensions;
 	int d_left = selected_dimensions.size();
     // for debugging purpose
     if (d_left == 0){
-        printf("error_1: d_left is 0\n");
-        exit(1);
+        return failed("error_1: d_left is 0");
     }
     
     // If no dimensions were removed in Phase 1, we need to handle this case
@@ -135,8 +147,7 @@ highdim_output* interactive_highdim(point_set_t* P_raw, point_set_t* skyline, in
                 // extract the first dimension in selected_dimensions
                 // for debugging purpose
                 if (selected_dimensions.size() == 0){
-                    printf("error_2: selected_dimensions is empty\n");
-                    exit(1);
+                    return failed("error_2: selected_dimensions is empty");
                 }
                 // construct the selected_dimensions set
                 std::set<int> selected_dimensions_i;
@@ -187,12 +198,10 @@ highdim_output* interactive_highdim(point_set_t* P_raw, point_set_t* skyline, in
             int group_size = pow(2, alpha);
             // for debugging purpose
             if (group_size == 0){
-                printf("error_3: group_size is 0\n");
-                exit(1);
+                return failed("error_3: group_size is 0");
             }
             if (group_size > d_left){
-                printf("error_4: group_size is greater than d_left\n");
-                exit(1);
+                return failed("error_4: group_size is greater than d_left");
             }
             int id;
             if (group_size == 1){
@@ -386,8 +395,7 @@ highdim_output* interactive_highdim(point_set_t* P_raw, point_set_t* skyline, in
                             // the dimension is in the left half, however cannot remove dimensions in the right half
                             // for debugging purpose
                             if (right == mid){
-                                printf("error_5: right == mid\n");
-                                exit(1);
+                                return failed("error_5: right == mid");
                             }
                             right = mid;
                         }
@@ -401,6 +409,7 @@ highdim_output* interactive_highdim(point_set_t* P_raw, point_set_t* skyline, in
     time_12 = duration_12.count();
 	// phase 3: find the optimal tuple or the optimal subset
     printf("Phase 3: Starting interactive questioning...\n");
+    session_phase(3);
 	// take the union of the final_dimensions and the selected_dimensions
 	std::set<int> set_final_dimensions;
     if (selected_dimensions.size() == 0 || final_dimensions.size() == d_bar){
@@ -434,14 +443,8 @@ highdim_output* interactive_highdim(point_set_t* P_raw, point_set_t* skyline, in
 
 	int final_d = set_final_dimensions.size();
     printf("number of final dimensions: %d\n", final_d);
-	point_set_t* D_prime = alloc_point_set(n);
-	for (int j=0;j<n;++j){
-		D_prime->points[j] = alloc_point(final_d);
-		D_prime->points[j]->id = skyline->points[j]->id;
-		for (int p=0;p<final_d;++p){
-			D_prime->points[j]->coord[p] = skyline->points[j]->coord[*next(set_final_dimensions.begin(), p)];
-		}
-	}
+	// view the skyline projected onto the final dimensions
+	projection_t* D_prime = alloc_projection(skyline, set_final_dimensions);
 
     // If user stopped in Phase 2 very early, still compute the subset using the
     // same attribute-subset/sphere logic as later, but skip interactive LP.
@@ -449,7 +452,7 @@ highdim_output* interactive_highdim(point_set_t* P_raw, point_set_t* skyline, in
         append_phase_record(stop_phase);
 
         // Take the skyline of D' and produce a subset of size K
-        point_set_t* skyline_D_prime = skyline_point(D_prime);
+        point_set_t* skyline_D_prime = subspace_skyline(D_prime);
 
         point_set_t* S_output = nullptr;
         if (K == 1) {
@@ -476,13 +479,13 @@ highdim_output* interactive_highdim(point_set_t* P_raw, point_set_t* skyline, in
         output->time_12 = time_12;
         output->time_3 = time_3;
         // Clean up
-        release_point_set(skyline_D_prime, false);
-        release_point_set(D_prime, true);
+        release_point_set(skyline_D_prime, true);
+        release_projection(D_prime);
         return output;
     }
 
-    // take the skyline of the newly constructed dataset D_prime
-    point_set_t* skyline_D_prime = skyline_point(D_prime);
+    // take the skyline of the projected dataset D_prime
+    point_set_t* skyline_D_prime = subspace_skyline(D_prime);
 
 
     // printf("number of points in skyline_D: %d\n", skyline_D_prime->numberOfPoints);
@@ -511,8 +514,11 @@ highdim_output* interactive_highdim(point_set_t* P_raw, point_set_t* skyline, in
             }
         }
         if (matched_point == nullptr) {
-            printf("Error: Could not find point in skyline with id %d\n", opt_p->id);
-            exit(1);
+            release_point_set(S_output, false);
+            release_point_set(skyline_D_prime, true);
+            release_projection(D_prime);
+            release_point(u_final);
+            return failed("Error: Could not find point in skyline with id " + std::to_string(opt_p->id));
         }
         S_output->points[0] = matched_point;
         num_questions -= Qcount;
@@ -538,8 +544,11 @@ highdim_output* interactive_highdim(point_set_t* P_raw, point_set_t* skyline, in
                     }
                 }
                 if (matched_point == nullptr) {
-                    printf("Error: Could not find point in skyline with id %d\n", target_id);
-                    exit(1);
+                    release_point_set(S_output, false);
+                    release_point_set(skyline_D_prime, true);
+                    release_projection(D_prime);
+                    release_point(u_final);
+                    return failed("Error: Could not find point in skyline with id " + std::to_string(target_id));
                 }
                 S_output->points[j] = matched_point;
             }
@@ -566,8 +575,8 @@ highdim_output* interactive_highdim(point_set_t* P_raw, point_set_t* skyline, in
     output->time_12 = time_12;
     output->time_3 = time_3;
     // release the memory
-    release_point_set(skyline_D_prime, false);
-    release_point_set(D_prime, true);
+    release_point_set(skyline_D_prime, true);
+    release_projection(D_prime);
     release_point(u_final);
     return output;
 }
@@ -4,6 +4,7 @@
 #include "other/GeoGreedy.h"
 #include "other/DMM.h"
 #include "other/lp.h"
+#include "other/skyline_cache.h"
 #include <iostream>
 #include "stdlib.h"
 #include "stdio.h"
@@ -12,6 +13,7 @@
 #include <chrono>
 #include <random>
 #include <set>
+#include <string>
 #include <vector>
 #include <algorithm>
 #include "other/data_struct.h"
@@ -29,6 +31,7 @@ struct highdim_output{
     std::set<int> final_dimensions;
     double time_12;
     double time_3;
+    std::string error; // why the run failed, empty if it succeeded (S is then empty)
 };
 
 // the complete interactive high-dimensional regret algorithm with attribute subset method
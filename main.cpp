@@ -26,10 +26,11 @@ int main(int argc, char *argv[]){
 	// if (argc != 8) return 0;
 	if (argc != 1) return 0;
 	char *input = (char*)"car.txt"; //char* input = argv[1];
-	point_set_t* P_raw = read_points(input);
+	// one copy of the dataset: normalized coordinates, with the raw values available through raw_coord
 	point_set_t* P = read_points(input);
 	int n = P->numberOfPoints;
 	linear_normalize(P);
+	point_set_t* P_raw = P;
 	// reduce_to_unit(P);
 	int d = P->points[0]->dim;
 	point_set_t* skyline = skyline_point(P);
@@ -94,7 +95,17 @@ int main(int argc, char *argv[]){
 	// // print the maximum utility point index
 	// printf("the maximum utility point index is %d, ID: %d\n", maxIdx, skyline->points[maxIdx]->id);
 
-	highdim_output* h = interactive_highdim(P_raw, skyline, size, d_bar, d_hat, d_hat_2, u, K, s, epsilon, maxRound, Qcount, Csize, cmp_option, stop_option, prune_option, dom_option, num_questions);
+	// run the algorithm as a session and answer its questions on stdin
+	highdim_output* h = NULL;
+	session_t* ss = alloc_session([&]{
+		h = interactive_highdim(P_raw, skyline, size, d_bar, d_hat, d_hat_2, u, K, s, epsilon, maxRound, Qcount, Csize, cmp_option, stop_option, prune_option, dom_option, num_questions);
+	});
+	const session_question_t* q;
+	while ((q = next_question(ss)) != NULL)
+		submit_answer(ss, ask_user(P_raw, q));
+	release_session(ss);
+	if (!h->error.empty())
+		return 1;
 	double time_12 = h->time_12;
 	double time_3 = h->time_3;
 	
@@ -115,19 +126,10 @@ int main(int argc, char *argv[]){
 	}
 	// for comparison, test the mrr returned by the Sphere algorithm
 	// construct the dataset with the final dimensions
-	point_set_t* D_test = alloc_point_set(n);
-	for (int i = 0; i < n; i++) {
-		D_test->points[i] = alloc_point(final_dimensions.size());
-		// Set the ID to be the array index so we can map back correctly
-		D_test->points[i]->id = i;
-		int j = 0;
-		for (auto dim : final_dimensions) {
-			D_test->points[i]->coord[j++] = skyline->points[i]->coord[dim];
-		}
-	}
+	projection_t* D_test = alloc_projection(skyline, final_dimensions);
 	// record the time in seconds
 	auto start_time_sphere = std::chrono::high_resolution_clock::now();
-	point_set_t* skyline_D_test = skyline_point(D_test);
+	point_set_t* skyline_D_test = subspace_skyline(D_test);
 	// point_set_t* S_test = sphereWSImpLP(skyline_D_test, K_sphere);
 	auto end_time_sphere = std::chrono::high_resolution_clock::now();
 	std::chrono::duration<double> duration_sphere = end_time_sphere - start_time_sphere;
@@ -190,28 +192,31 @@ int main(int argc, char *argv[]){
 	for (int i = 0; i < S->numberOfPoints; i++) {
 		printf("Option %d: ", S->points[i]->id);
 		for (int j = 0; j < final_dimensions.size(); j++) {
-			// find the id to use P_raw
-			int id = S->points[i]->id;
-			for (int k = 0; k < P_raw->numberOfPoints; k++) {
-				if (P_raw->points[k]->id == id) {
-					id = k;
-					break;
-				}
-			}
-			printf("dim %d: %f ", *next(final_dimensions.begin(), j), P_raw->points[id]->coord[*next(final_dimensions.begin(), j)]);
+			printf("dim %d: %f ", *next(final_dimensions.begin(), j), raw_coord(P_raw, S->points[i]->id, *next(final_dimensions.begin(), j)));
 		}
 		printf("\n");
 	}
 
 	printf("number of questions: %d\n", num_quest_init-num_questions); // 555
+	skyline_cache_stats_t cache_stats = skyline_cache_stats();
+	printf("subspace skyline cache: %lld hits, %lld misses\n", cache_stats.hits, cache_stats.misses);
+	std::vector<double> lp_times = sphere_lp_round_times();
+	if (!lp_times.empty()) {
+		printf("sphere LP time per round (s):");
+		for (int i = 0; i < (int)lp_times.size(); i++)
+			printf(" %.4f", lp_times[i]);
+		printf("\n");
+	}
+	sphere_lp_stats_t lp_stats = sphere_lp_stats();
+	if (lp_stats.solved > 0)
+		printf("sphere LPs: %lld solved (%lld warm-started), %lld avoided\n", lp_stats.solved, lp_stats.warm, lp_stats.avoided);
 
 	release_point_set(skyline, false);
 	release_point(u);
 	release_point_set(h->S, false);
 	release_point_set(P, true);
-	release_point_set(P_raw, true);
-	release_point_set(D_test, true);
-	release_point_set(skyline_D_test, false);
+	release_projection(D_test);
+	release_point_set(skyline_D_test, true);
 	// release_point_set(S_test, false); // Don't clear since points are references
 	// release_point_set(S_test_original, true);
 	delete h;
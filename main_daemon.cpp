@@ -0,0 +1,523 @@
+#include "other/data_utility.h"
+#include "other/operation.h"
+#include "other/read_write.h"
+#include "other/session.h"
+#include "highdim.h"
+
+#include "stdlib.h"
+#include "stdio.h"
+#include "string.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Engine daemon: serves many interactive_highdim sessions from one process over a Unix domain socket.
+ *
+ * A dataset is read, normalized and reduced to its skyline by the first session that uses it, and shared
+ * read-only by every later one, so starting a session costs a table insert and the run to its first question.
+ *
+ * Requests and replies are single lines of space-separated words:
+ *
+ *   start <dataset> [<name>]   start a session on <dataset>, a file in the dataset directory given by a path
+ *                              relative to it; <name> is the id of its session file (default: the session id)
+ *   answer <sid> <choice>      answer the pending question: 0 for not interested, i for option i, -99 to stop
+ *   status <sid>               repeat the state of a session
+ *   stop <sid>                 end a session and forget it
+ *
+ * start, answer and status reply with the state of the session:
+ *
+ *   question <sid> <phase> <dims> <option>...  dims is the comma-separated list of dimensions shown, and each
+ *                                              option is <id>:<value>,<value>,... with its raw values on dims
+ *   done <sid> <dims> <option>...              the recommendation, in the same format
+ *   failed <sid> <message>                     the run ended without a recommendation
+ *
+ * stop replies "stopped <sid>", and a failed request "error <sid or -> <message>".
+ *
+ * A session is resumed on the thread that started it, so session sid lives on worker sid % DAEMON_THREADS
+ * (default: the number of cores). Replies to requests on different sessions may come back in any order.
+ * A session belongs to the connection that started it and is released when that connection closes.
+ *
+ * A worker never waits for a client: what the socket does not take at once is queued on the connection and
+ * written by the main thread, and a client that lets more than max_output bytes queue up is disconnected.
+ */
+
+// the parameters of run_web
+static const int S_size = 2; // options per question
+static const int d_hat = 7;
+static const int d_hat_2 = 6;
+static const int K = 10;
+static const int d_bar = 5;
+static const int num_quest_init = 100;
+static const int s = 2;
+static const double epsilon = 0.0;
+static const int maxRound = 1000;
+static const int prune_option = RTREE;
+static const int dom_option = HYPER_PLANE;
+static const int stop_option = EXACT_BOUND;
+static const int cmp_option = RANDOM;
+
+static const size_t max_output = 1 << 20; // bytes of replies queued for a client before it is disconnected
+
+// the pipe waking the main thread when a worker has queued output or dropped a connection
+static int wake_fds[2];
+
+static void wake_main() {
+    char c = 0;
+    ssize_t k = write(wake_fds[1], &c, 1); // a full pipe wakes the main thread all the same
+    (void)k;
+}
+
+// a client connection; replies of several workers are queued whole under the mutex
+struct connection {
+    int fd;
+    std::mutex m;
+    std::string out;    // replies the socket has not taken yet
+    bool dropped;       // the client went away or stopped reading; the main thread closes the connection
+    std::set<int> sids; // the sessions started on this connection, only touched by the main thread
+
+    connection(int fd) : fd(fd), dropped(false) {}
+    ~connection() { close(fd); }
+
+    // write as much of out as the socket takes without blocking; false if the client went away. Called under m
+    bool flush() {
+        while (!out.empty()) {
+            ssize_t k = send(fd, out.data(), out.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (k < 0 && errno == EINTR)
+                continue;
+            if (k < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return true;
+            if (k <= 0)
+                return false;
+            out.erase(0, k);
+        }
+        return true;
+    }
+
+    bool gone() {
+        std::lock_guard<std::mutex> lock(m);
+        return dropped;
+    }
+
+    void reply(const std::string& line) {
+        std::lock_guard<std::mutex> lock(m);
+        if (dropped)
+            return;
+        out += line;
+        out += "\n";
+        if (!flush() || out.size() > max_output)
+            dropped = true; // its sessions are released once the main thread closes the connection
+        if (dropped || !out.empty())
+            wake_main();
+    }
+};
+
+// a dataset shared by its sessions
+struct dataset {
+    point_set_t* P;
+    point_set_t* skyline;
+};
+
+// a running session, only touched by its worker
+struct engine_session {
+    dataset* data;
+    point_t* u;
+    session_t* ss;
+    highdim_output* h;
+    double Qcount, Csize;
+    int num_questions;
+};
+
+// a request routed to the worker of its session
+struct job {
+    std::shared_ptr<connection> conn;
+    std::vector<std::string> words;
+    int sid;
+};
+
+struct worker {
+    std::thread thread;
+    std::mutex m;
+    std::condition_variable wake;
+    std::deque<job> jobs;
+    std::unordered_map<int, engine_session*> sessions;
+};
+
+static std::string dataset_dir; // the resolved path of the only directory datasets are read from
+static std::mutex datasets_mutex;
+static std::map<std::string, dataset*> datasets;
+
+// the dataset at name, relative to the dataset directory, loaded on first use; NULL if it lies outside the
+// directory or is missing or malformed
+static dataset* load_dataset(const std::string& name) {
+    char* resolved = realpath((dataset_dir + "/" + name).c_str(), NULL);
+    if (resolved == NULL)
+        return NULL;
+    std::string path = resolved;
+    free(resolved);
+    std::string prefix = dataset_dir == "/" ? dataset_dir : dataset_dir + "/";
+    if (path.compare(0, prefix.size(), prefix) != 0)
+        return NULL;
+
+    // held while loading, so concurrent starts on a new dataset load it once
+    std::lock_guard<std::mutex> lock(datasets_mutex);
+    auto it = datasets.find(path);
+    if (it != datasets.end())
+        return it->second;
+
+    // only skyline points are shown, so the skyline also serves raw_coord
+    int n;
+    point_set_t* skyline = load_skyline((char*)path.c_str(), &n);
+    if (skyline == NULL)
+        return NULL;
+    dataset* data = new dataset;
+    data->skyline = skyline;
+    data->P = data->skyline;
+    datasets[path] = data;
+    printf("Dataset %s loaded: %d points, %d dimensions, %d skyline points\n", path.c_str(), n, data->P->points[0]->dim, data->skyline->numberOfPoints);
+    return data;
+}
+
+// "<dims> <option>..." as sent in question and done replies
+static std::string format_options(point_set_t* P_raw, const std::set<int>& dimensions, const std::vector<int>& ids) {
+    std::ostringstream out;
+    out.precision(10);
+    for (std::set<int>::const_iterator it = dimensions.begin(); it != dimensions.end(); ++it)
+        out << (it == dimensions.begin() ? "" : ",") << *it;
+    for (int i = 0; i < (int)ids.size(); i++) {
+        out << " " << ids[i] << ":";
+        for (std::set<int>::const_iterator it = dimensions.begin(); it != dimensions.end(); ++it)
+            out << (it == dimensions.begin() ? "" : ",") << raw_coord(P_raw, ids[i], *it);
+    }
+    return out.str();
+}
+
+// run the session to its next question and describe its state
+static std::string session_state(int sid, engine_session* es) {
+    const session_question_t* q = next_question(es->ss);
+    if (q != NULL)
+        return "question " + std::to_string(sid) + " " + std::to_string(q->phase) + " " + format_options(es->data->P, q->dimensions, q->ids);
+    if (!es->h->error.empty())
+        return "failed " + std::to_string(sid) + " " + es->h->error;
+
+    std::vector<int> ids;
+    for (int i = 0; i < es->h->S->numberOfPoints; i++)
+        ids.push_back(es->h->S->points[i]->id);
+    return "done " + std::to_string(sid) + " " + format_options(es->data->P, es->h->final_dimensions, ids);
+}
+
+static void release_engine_session(engine_session* es) {
+    release_session(es->ss);
+    release_point_set(es->h->S, false);
+    release_point(es->u);
+    delete es->h;
+    delete es;
+}
+
+static engine_session* start_session(int sid, dataset* data, const std::string& name) {
+    engine_session* es = new engine_session;
+    es->data = data;
+    es->h = NULL;
+    es->num_questions = num_quest_init;
+
+    // the answers come from the user; u only feeds the simulated user of the offline runs
+    int d = data->P->points[0]->dim;
+    es->u = alloc_point(d);
+    for (int i = 0; i < d; i++)
+        es->u->coord[i] = 1.0 / d;
+
+    es->ss = alloc_session([es]{
+        es->h = interactive_highdim(es->data->P, es->data->skyline, S_size, d_bar, d_hat, d_hat_2, es->u, K, s, epsilon, maxRound, es->Qcount, es->Csize, cmp_option, stop_option, prune_option, dom_option, es->num_questions);
+    });
+    es->ss->name = name.empty() ? std::to_string(sid) : name;
+    return es;
+}
+
+static void handle(worker* w, job& jb) {
+    const std::string& cmd = jb.words[0];
+    std::string sid_str = std::to_string(jb.sid);
+
+    // the requests still queued from a closed connection have nobody to reply to, only its sessions to release
+    if (cmd != "release" && jb.conn->gone())
+        return;
+
+    if (cmd == "start") {
+        if (jb.words.size() < 2 || jb.words.size() > 3) {
+            jb.conn->reply("error - usage: start <dataset> [<name>]");
+            return;
+        }
+        dataset* data = load_dataset(jb.words[1]);
+        if (data == NULL) {
+            jb.conn->reply("error - cannot load dataset " + jb.words[1]);
+            return;
+        }
+        engine_session* es = start_session(jb.sid, data, jb.words.size() == 3 ? jb.words[2] : std::string());
+        w->sessions[jb.sid] = es;
+        jb.conn->reply(session_state(jb.sid, es));
+        return;
+    }
+
+    auto it = w->sessions.find(jb.sid);
+    if (it == w->sessions.end()) {
+        // a session stopped before its connection closed has nothing left to release
+        if (cmd != "release")
+            jb.conn->reply("error " + sid_str + " no such session");
+        return;
+    }
+    engine_session* es = it->second;
+
+    if (cmd == "answer") {
+        char* end;
+        long answer = jb.words.size() == 3 ? strtol(jb.words[2].c_str(), &end, 10) : 0;
+        if (jb.words.size() != 3 || *end != '\0' || !submit_answer(es->ss, (int)answer)) {
+            jb.conn->reply("error " + sid_str + " no question pending or answer out of range");
+            return;
+        }
+        jb.conn->reply(session_state(jb.sid, es));
+    }
+    else if (cmd == "status") {
+        jb.conn->reply(session_state(jb.sid, es));
+    }
+    else if (cmd == "stop") {
+        w->sessions.erase(it);
+        release_engine_session(es);
+        jb.conn->reply("stopped " + sid_str);
+    }
+    else if (cmd == "release") {
+        // queued when the connection of the session closed; nobody waits for a reply
+        w->sessions.erase(it);
+        release_engine_session(es);
+    }
+}
+
+static void run_worker(worker* w) {
+    for (;;) {
+        std::unique_lock<std::mutex> lock(w->m);
+        w->wake.wait(lock, [w]{ return !w->jobs.empty(); });
+        job jb = w->jobs.front();
+        w->jobs.pop_front();
+        lock.unlock();
+
+        handle(w, jb);
+    }
+}
+
+// queue a request on the worker of its session
+static void queue_job(std::vector<worker*>& workers, const job& jb) {
+    worker* w = workers[jb.sid % workers.size()];
+    std::lock_guard<std::mutex> lock(w->m);
+    w->jobs.push_back(jb);
+    w->wake.notify_one();
+}
+
+// parse a request line and queue it on the worker of its session
+static void dispatch(std::vector<worker*>& workers, int& next_sid, const std::shared_ptr<connection>& conn, const std::string& line) {
+    std::istringstream in(line);
+    job jb;
+    jb.conn = conn;
+    std::string word;
+    while (in >> word)
+        jb.words.push_back(word);
+    if (jb.words.empty())
+        return;
+
+    const std::string& cmd = jb.words[0];
+    if (cmd == "start") {
+        jb.sid = next_sid++;
+        conn->sids.insert(jb.sid);
+    }
+    else if (cmd == "answer" || cmd == "status" || cmd == "stop") {
+        // a client can only act on the sessions it started
+        char* end;
+        long sid = jb.words.size() >= 2 ? strtol(jb.words[1].c_str(), &end, 10) : -1;
+        if (jb.words.size() < 2 || *end != '\0' || sid < 0 || sid >= next_sid || conn->sids.count((int)sid) == 0) {
+            conn->reply("error - no such session");
+            return;
+        }
+        jb.sid = (int)sid;
+        if (cmd == "stop")
+            conn->sids.erase(jb.sid); // released by the stop itself
+    }
+    else {
+        conn->reply("error - unknown command " + cmd);
+        return;
+    }
+
+    queue_job(workers, jb);
+}
+
+// release the sessions of a closed connection, after the requests already queued on them
+static void release_sessions(std::vector<worker*>& workers, const std::shared_ptr<connection>& conn) {
+    for (int sid : conn->sids) {
+        job jb;
+        jb.conn = conn;
+        jb.words.push_back("release");
+        jb.sid = sid;
+        queue_job(workers, jb);
+    }
+}
+
+// close a connection: the client sees it end at once, the replies still coming from the workers are discarded,
+// and the socket is closed once the last queued request on it is done
+static void drop_connection(std::vector<worker*>& workers, const std::shared_ptr<connection>& conn) {
+    {
+        std::lock_guard<std::mutex> lock(conn->m);
+        conn->dropped = true;
+        conn->out.clear();
+    }
+    shutdown(conn->fd, SHUT_RDWR);
+    release_sessions(workers, conn);
+}
+
+int main(int argc, char *argv[]) {
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    if (argc < 2 || argc > 3) {
+        printf("Usage: %s <socket path> [<dataset directory>]\n", argv[0]);
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    // start requests name datasets in this directory only: the working directory by default
+    char* dir = realpath(argc == 3 ? argv[2] : ".", NULL);
+    if (dir == NULL) {
+        printf("Cannot use dataset directory %s: %s\n", argc == 3 ? argv[2] : ".", strerror(errno));
+        return 1;
+    }
+    dataset_dir = dir;
+    free(dir);
+
+    if (pipe(wake_fds) != 0 || fcntl(wake_fds[0], F_SETFL, O_NONBLOCK) != 0 || fcntl(wake_fds[1], F_SETFL, O_NONBLOCK) != 0) {
+        printf("Cannot create the wake pipe: %s\n", strerror(errno));
+        return 1;
+    }
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(argv[1]) >= sizeof(addr.sun_path)) {
+        printf("Socket path too long: %s\n", argv[1]);
+        return 1;
+    }
+    strcpy(addr.sun_path, argv[1]);
+    unlink(argv[1]);
+    if (listen_fd < 0 || bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd, 64) < 0) {
+        printf("Cannot listen on %s: %s\n", argv[1], strerror(errno));
+        return 1;
+    }
+
+    int threads = std::thread::hardware_concurrency();
+    const char* env = getenv("DAEMON_THREADS");
+    if (env != NULL && atoi(env) > 0)
+        threads = atoi(env);
+    if (threads < 1)
+        threads = 1;
+
+    std::vector<worker*> workers;
+    for (int i = 0; i < threads; i++) {
+        worker* w = new worker;
+        w->thread = std::thread(run_worker, w);
+        workers.push_back(w);
+    }
+    printf("Engine daemon listening on %s with %d workers, datasets in %s\n", argv[1], threads, dataset_dir.c_str());
+
+    // the listening socket and the wake pipe first, then one entry per connection with its partial line
+    const size_t first_conn = 2;
+    std::vector<struct pollfd> fds(first_conn);
+    fds[0].fd = listen_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = wake_fds[0];
+    fds[1].events = POLLIN;
+    std::vector<std::shared_ptr<connection> > conns(first_conn);
+    std::vector<std::string> pending(first_conn);
+    int next_sid = 0;
+    char buffer[4096];
+
+    for (;;) {
+        // close the connections the workers dropped, and wait to write to those with queued replies
+        for (size_t i = fds.size() - 1; i >= first_conn; i--) {
+            bool dropped, queued;
+            {
+                std::lock_guard<std::mutex> lock(conns[i]->m);
+                dropped = conns[i]->dropped;
+                queued = !conns[i]->out.empty();
+            }
+            if (dropped) {
+                drop_connection(workers, conns[i]);
+                fds.erase(fds.begin() + i);
+                conns.erase(conns.begin() + i);
+                pending.erase(pending.begin() + i);
+                continue;
+            }
+            fds[i].events = POLLIN | (queued ? POLLOUT : 0);
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            printf("poll failed: %s\n", strerror(errno));
+            return 1;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            while (read(wake_fds[0], buffer, sizeof(buffer)) > 0) {}
+        }
+
+        for (size_t i = fds.size() - 1; i >= first_conn; i--) {
+            if (fds[i].revents == 0)
+                continue;
+            bool closed = false;
+            if (fds[i].revents & POLLOUT) {
+                std::lock_guard<std::mutex> lock(conns[i]->m);
+                closed = !conns[i]->flush();
+            }
+            ssize_t k = 0;
+            if (!closed && (fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                k = read(fds[i].fd, buffer, sizeof(buffer));
+                closed = k <= 0;
+            }
+            if (closed) {
+                // the sessions of the connection are released after the requests already queued on them
+                drop_connection(workers, conns[i]);
+                fds.erase(fds.begin() + i);
+                conns.erase(conns.begin() + i);
+                pending.erase(pending.begin() + i);
+                continue;
+            }
+            pending[i].append(buffer, k);
+            size_t eol;
+            while ((eol = pending[i].find('\n')) != std::string::npos) {
+                dispatch(workers, next_sid, conns[i], pending[i].substr(0, eol));
+                pending[i].erase(0, eol + 1);
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(listen_fd, NULL, NULL);
+            if (fd >= 0) {
+                struct pollfd p;
+                p.fd = fd;
+                p.events = POLLIN;
+                p.revents = 0;
+                fds.push_back(p);
+                conns.push_back(std::make_shared<connection>(fd));
+                pending.push_back(std::string());
+            }
+        }
+    }
+}
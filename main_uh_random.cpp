@@ -64,15 +64,15 @@ int main(int argc, char *argv[]){
         fclose(test_fp);
     }
     
-    point_set_t* P_raw = read_points(input);
-    if (!P_raw) {
+    // one copy of the dataset: normalized coordinates, with the raw values available through raw_coord
+    point_set_t* P = read_points(input);
+    if (!P) {
         printf("Error: Could not load dataset %s\n", input);
         return 1;
     }
-    
-    point_set_t* P = read_points(input);
     int n = P->numberOfPoints;
     linear_normalize(P);
+    point_set_t* P_raw = P;
     int d = P->points[0]->dim;
     
     printf("Dataset loaded: %d points, %d dimensions\n", n, d);
@@ -99,19 +99,21 @@ int main(int argc, char *argv[]){
     }
 
     printf("number of final dimensions: %d\n", final_d);
-	point_set_t* D_prime = alloc_point_set(n);
-	for (int j=0;j<n;++j){
-		D_prime->points[j] = alloc_point(final_d);
-		D_prime->points[j]->id = skyline->points[j]->id;
-		for (int p=0;p<final_d;++p){
-			D_prime->points[j]->coord[p] = skyline->points[j]->coord[*next(set_final_dimensions.begin(), p)];
-		}
-	}
+	// view the skyline projected onto the final dimensions
+	projection_t* D_prime = alloc_projection(skyline, set_final_dimensions);
 
-    point_set_t* skyline_D_prime = skyline_point(D_prime);
+    point_set_t* skyline_D_prime = subspace_skyline(D_prime);
 
     // Use max_utility_with_questions instead of max_utility to incorporate pre-recorded questions
-    point_t* opt_p = max_utility(P_raw, set_final_dimensions, skyline_D_prime, u, s, epsilon, num_questions, Qcount, Csize, cmp_option, stop_option, prune_option, dom_option);
+    // run max_utility as a session and answer its questions on stdin
+    point_t* opt_p = NULL;
+    session_t* ss = alloc_session([&]{
+        opt_p = max_utility(P_raw, set_final_dimensions, skyline_D_prime, u, s, epsilon, num_questions, Qcount, Csize, cmp_option, stop_option, prune_option, dom_option);
+    });
+    const session_question_t* q;
+    while ((q = next_question(ss)) != NULL)
+        submit_answer(ss, ask_user(P_raw, q));
+    release_session(ss);
     // Find the point in skyline that matches the id of opt_p
     point_t* matched_point = nullptr;
     for (int i = 0; i < n; ++i) {
@@ -128,15 +130,7 @@ int main(int argc, char *argv[]){
     printf("\n=== FINAL RECOMMENDATION ===\n");
     printf("Option %d: ", matched_point->id);
     for (int j = 0; j < final_d; j++) {
-        // find the id to use P_raw
-        int id = matched_point->id;
-        for (int k = 0; k < P_raw->numberOfPoints; k++) {
-            if (P_raw->points[k]->id == id) {
-                id = k;
-                break;
-            }
-        }
-        printf("dim %d: %.4f ", *next(set_final_dimensions.begin(), j), P_raw->points[id]->coord[*next(set_final_dimensions.begin(), j)]);
+        printf("dim %d: %.4f ", *next(set_final_dimensions.begin(), j), raw_coord(P_raw, matched_point->id, *next(set_final_dimensions.begin(), j)));
     }
     printf("\n");
 
@@ -147,9 +141,8 @@ int main(int argc, char *argv[]){
     release_point_set(skyline, false);
     release_point(u);
     release_point_set(P, true);
-    release_point_set(P_raw, true);
-    release_point_set(D_prime, true);
-    release_point_set(skyline_D_prime, false);
+    release_projection(D_prime);
+    release_point_set(skyline_D_prime, true);
     
     return 0;
 }
@@ -4,6 +4,7 @@
 #include "other/GeoGreedy.h"
 #include "other/DMM.h"
 #include "other/lp.h"
+#include "other/read_write.h"
 #include "highdim.h"
 
 #include <iostream>
@@ -20,6 +21,76 @@ using namespace std;
 #include <string>
 #include <sstream>
 #include <thread>
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Zygote mode: serve sessions from the loaded dataset. Every connection to the socket at path gets a forked
+// child sharing the dataset and skyline copy-on-write. The client sends the session id (possibly empty) on
+// the first line; after that the connection is the stdin/stdout of the session, as the pipes of run_web are.
+// Returns only in a child, which then runs its session.
+static void serve_sessions(const char* path) {
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        printf("ERROR: Socket path too long: %s\n", path);
+        exit(1);
+    }
+    strcpy(addr.sun_path, path);
+    unlink(path);
+    if (listen_fd < 0 || bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd, 64) < 0) {
+        printf("ERROR: Cannot listen on %s: %s\n", path, strerror(errno));
+        exit(1);
+    }
+
+    // finished sessions are reaped by the kernel
+    signal(SIGCHLD, SIG_IGN);
+    printf("Zygote listening on %s\n", path);
+
+    for (;;) {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno != EINTR)
+                printf("accept failed: %s\n", strerror(errno));
+            continue;
+        }
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            printf("fork failed: %s\n", strerror(errno));
+            close(fd);
+            continue;
+        }
+        if (pid > 0) {
+            close(fd);
+            continue;
+        }
+
+        close(listen_fd);
+        signal(SIGCHLD, SIG_DFL);
+
+        // the id line is read a byte at a time, so the answers after it stay in the socket for scanf
+        std::string sid;
+        char c;
+        while (read(fd, &c, 1) == 1 && c != '\n')
+            sid.push_back(c);
+        if (!sid.empty() && sid.back() == '\r')
+            sid.pop_back();
+        if (!sid.empty())
+            setenv("SESSION_ID", sid.c_str(), 1);
+
+        dup2(fd, STDIN_FILENO);
+        dup2(fd, STDOUT_FILENO);
+        dup2(fd, STDERR_FILENO);
+        close(fd);
+        return;
+    }
+}
 
 // Real interactive version for web interface
 int main(int argc, char *argv[]){
@@ -49,7 +120,13 @@ int main(int argc, char *argv[]){
     int stop_option = EXACT_BOUND;
     int cmp_option = RANDOM;
     
-    // Allow dataset selection via command line
+    // Allow dataset selection via command line; run_web --zygote <socket> [dataset] serves sessions instead
+    const char* zygote_socket = NULL;
+    if (argc > 2 && strcmp(argv[1], "--zygote") == 0) {
+        zygote_socket = argv[2];
+        argv += 2;
+        argc -= 2;
+    }
     if (argc > 1) {
         input = argv[1];
     }
@@ -72,25 +149,22 @@ int main(int argc, char *argv[]){
         fclose(test_fp);
     }
     
-    point_set_t* P_raw = read_points(input);
-    if (!P_raw) {
-        printf("Error: Could not load dataset %s\n", input);
-        return 1;
-    }
-    
-    point_set_t* P = read_points(input);
-    int n = P->numberOfPoints;
-    linear_normalize(P);
-    int d = P->points[0]->dim;
+    // the normalized skyline, mapped from the preprocessed cache of the dataset when it is valid.
+    // Only skyline points are ever shown, so it is also the point set raw_coord reads the raw values from.
+    int n;
+    point_set_t* skyline = read_skyline(input, &n);
+    point_set_t* P_raw = skyline;
+    int d = skyline->points[0]->dim;
     
     printf("Dataset loaded: %d points, %d dimensions\n", n, d);
-    
-    point_set_t* skyline = skyline_point(P);
     printf("Skyline computed: %d points\n", skyline->numberOfPoints);
     
     // Set n to be the number of skyline points
     n = skyline->numberOfPoints;
 
+    if (zygote_socket != NULL)
+        serve_sessions(zygote_socket);
+
     // Generate utility vector
     point_t* u = alloc_point(d);
     for (int i = 0; i < d; i++) u->coord[i] = 0;
@@ -134,8 +208,25 @@ int main(int argc, char *argv[]){
     printf("Initializing algorithm phases...\n");
     printf("========================================\n");
 
-    // Run the real interactive algorithm
-    highdim_output* h = interactive_highdim(P_raw, skyline, size, d_bar, d_hat, d_hat_2, u, K, s, epsilon, maxRound, Qcount, Csize, cmp_option, stop_option, prune_option, dom_option, num_questions);
+    // Run the real interactive algorithm as a session, answering its questions on stdin
+    highdim_output* h = NULL;
+    session_t* ss = alloc_session([&]{
+        h = interactive_highdim(P_raw, skyline, size, d_bar, d_hat, d_hat_2, u, K, s, epsilon, maxRound, Qcount, Csize, cmp_option, stop_option, prune_option, dom_option, num_questions);
+    });
+    const session_question_t* q;
+    while ((q = next_question(ss)) != NULL)
+        submit_answer(ss, ask_user(P_raw, q));
+    release_session(ss);
+
+    // the run failed and printed why; there is no recommendation to show
+    if (!h->error.empty()) {
+        fflush(stdout);
+        release_point(u);
+        release_point_set(h->S, false);
+        release_point_set(skyline, true);
+        delete h;
+        return 1;
+    }
     
     double time_12 = h->time_12;
     double time_3 = h->time_3;
@@ -155,15 +246,7 @@ int main(int argc, char *argv[]){
     for (int i = 0; i < S->numberOfPoints; i++) {
         printf("Option %d: ", S->points[i]->id);
         for (int j = 0; j < final_dimensions.size(); j++) {
-            // find the id to use P_raw
-            int id = S->points[i]->id;
-            for (int k = 0; k < P_raw->numberOfPoints; k++) {
-                if (P_raw->points[k]->id == id) {
-                    id = k;
-                    break;
-                }
-            }
-            printf("dim %d: %.4f ", *next(final_dimensions.begin(), j), P_raw->points[id]->coord[*next(final_dimensions.begin(), j)]);
+            printf("dim %d: %.4f ", *next(final_dimensions.begin(), j), raw_coord(P_raw, S->points[i]->id, *next(final_dimensions.begin(), j)));
         }
         printf("\n");
     }
@@ -173,11 +256,9 @@ int main(int argc, char *argv[]){
 
     // Cleanup
     fflush(stdout);
-    release_point_set(skyline, false);
     release_point(u);
     release_point_set(h->S, false);
-    release_point_set(P, true);
-    release_point_set(P_raw, true);
+    release_point_set(skyline, true);
     delete h;
     // Emit a completion marker and give the reader a brief window to consume
     printf("\n=== DONE ===\n");
@@ -6,6 +6,7 @@
 #include<string.h>
 #include<stdio.h>
 #include<stdlib.h>
+#include<stdint.h>
 #include <vector>
 #include <iostream>
 #include <iterator>
@@ -51,7 +52,7 @@
 #define RAMDOM_P 3
 #define HEURISTIC 2
 
-#define LABEL_LENGTH 150
+#define STORE_ALIGNMENT 64
 
 // data structure for storing points.
 typedef struct point
@@ -60,17 +61,52 @@ typedef struct point
 	COORD_TYPE*	coord;
 
 	int			id;
-	char		label[LABEL_LENGTH];
 	
 }	point_t;
 
+// data structure for storing the points of a point set contiguously.
+// The coordinates are kept row by row in one block aligned to STORE_ALIGNMENT bytes;
+// rows[i] is a point_t whose coord views row i of the block.
+typedef struct point_store
+{
+	int			numberOfPoints;
+	int			dim;
+	COORD_TYPE*	coord;
+	point_t*	rows;
+
+	// id->row map, row_of[id] = -1 if no row has this id
+	int			maxId;
+	int*		row_of;
+
+	// the raw range of each dimension if coord has been normalized, NULL otherwise;
+	// they point into the mapping if the store is mapped
+	COORD_TYPE*	min;
+	COORD_TYPE*	max;
+
+	// the memory mapped file holding coord, NULL if coord is malloc'd
+	void*		mapping;
+	size_t		mapping_size;
+
+}	point_store_t;
+
 // data structure for storing point set.
+// If store is not NULL, the points are the rows of store and are released together with it.
 typedef struct point_set
 {
 	int numberOfPoints;
 	point_t **points;
+	point_store_t* store;
+	uint64_t fingerprint;	// hash of the ids and coordinates, computed by the subspace skyline cache; 0 until then
 }	point_set_t;
 
+// data structure for viewing a point set projected onto some of its dimensions without copying the points.
+typedef struct projection
+{
+	point_set_t* base;
+	int dim;
+	int* dims;	// dims[k]: the dimension of base that is dimension k of the projection
+}	projection_t;
+
 // data structure for storing hyperplane.
 typedef struct hyperplane
 {
@@ -108,19 +144,27 @@ typedef struct node {
 
 }   node_type;
 
+// R-tree related data structures
+// an entry of the BBS heap: the node and its key, the squared distance from its top corner b to (1, ..., 1)
+typedef struct bbs_entry
+{
+	double key;
+	node_type* node;
+
+	bbs_entry(node_type* n) : node(n)
+	{
+		key = 0;
+		for (int i = 0; i < n->dim; i++)
+			key += (1 - n->b[i]) * (1 - n->b[i]);
+	}
+} bbs_entry_t;
+
 // R-tree related data structures
 struct nodeCmp
 {
-	bool operator()(const node_type* lhs, const node_type* rhs) const
+	bool operator()(const bbs_entry_t& lhs, const bbs_entry_t& rhs) const
 	{
-		double dist1 = 0, dist2 = 0;
-		for (int i = 0; i < lhs->dim; i++)
-		{
-			dist1 += pow(1 - lhs->b[i], 2);
-			dist2 += pow(1 - rhs->b[i], 2);
-		}
-
-		return dist1 > dist2;
+		return lhs.key > rhs.key;
 	}
 };
 
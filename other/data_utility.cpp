@@ -1,6 +1,7 @@
 //#include "stdafx.h"
 
 #include "data_utility.h"
+#include <sys/mman.h>
 
 
 /*
@@ -114,6 +115,30 @@ point_set_t* alloc_point_set(int numberOfPoints)
 	return point_set_v;
 }
 
+/*
+ *	Allocate memory for numberOfPoints number of points in dim-dimensional space,
+ *	backed by a point store
+ */
+point_set_t* alloc_point_set(int numberOfPoints, int dim)
+{
+	return alloc_point_set(alloc_point_store(numberOfPoints, dim));
+}
+
+/*
+ *	Allocate memory for a point set whose points are the rows of store_v
+ *	(the point set takes over store_v)
+ */
+point_set_t* alloc_point_set(point_store_t* store_v)
+{
+	point_set_t* point_set_v = alloc_point_set(store_v->numberOfPoints);
+
+	point_set_v->store = store_v;
+	for(int i = 0; i < store_v->numberOfPoints; i++)
+		point_set_v->points[i] = &store_v->rows[i];
+
+	return point_set_v;
+}
+
 /*
  *	Release memory for numberOfPoints number of points
  */
@@ -124,7 +149,9 @@ void release_point_set(point_set_t* &point_set_v, bool clear)
 
 	if(point_set_v->points != NULL)
 	{
-		if(clear)
+		if(clear && point_set_v->store != NULL)
+			release_point_store(point_set_v->store);
+		else if(clear)
 		{
 			for(int i = 0; i < point_set_v->numberOfPoints; i++)
 				release_point( point_set_v->points[i]);
@@ -138,6 +165,196 @@ void release_point_set(point_set_t* &point_set_v, bool clear)
 	point_set_v = NULL;
 }
 
+/*
+ *	Allocate memory for numberOfPoints number of points in dim-dimensional space,
+ *	stored contiguously row by row
+ */
+point_store_t* alloc_point_store(int numberOfPoints, int dim)
+{
+	point_store_t* store_v;
+
+	store_v = (point_store_t*)malloc(sizeof(point_store_t));
+	memset(store_v, 0, sizeof(point_store_t));
+
+	store_v->numberOfPoints = numberOfPoints;
+	store_v->dim = dim;
+	store_v->maxId = -1;
+
+	// round the block up to whole cache lines so that scans never share a line with other data
+	size_t size = (size_t)numberOfPoints * dim * sizeof(COORD_TYPE);
+	size = (size + STORE_ALIGNMENT - 1) / STORE_ALIGNMENT * STORE_ALIGNMENT;
+	if(size == 0)
+		size = STORE_ALIGNMENT;
+
+	void* block = NULL;
+	if(posix_memalign(&block, STORE_ALIGNMENT, size) != 0)
+	{
+		printf("Cannot allocate a point store of %d points\n", numberOfPoints);
+		exit(0);
+	}
+	memset(block, 0, size);
+	store_v->coord = (COORD_TYPE*)block;
+
+	store_v->rows = (point_t*)malloc((numberOfPoints > 0 ? numberOfPoints : 1) * sizeof(point_t));
+	for(int i = 0; i < numberOfPoints; i++)
+	{
+		store_v->rows[i].dim = dim;
+		store_v->rows[i].coord = store_v->coord + (size_t)i * dim;
+		store_v->rows[i].id = -1;
+	}
+
+	return store_v;
+}
+
+/*
+ *	Build a point store over coordinates that live at coord_offset of a memory mapped file
+ *	(the store takes over the mapping and unmaps it on release)
+ */
+point_store_t* map_point_store(int numberOfPoints, int dim, void* mapping, size_t mapping_size, size_t coord_offset)
+{
+	point_store_t* store_v;
+
+	store_v = (point_store_t*)malloc(sizeof(point_store_t));
+	memset(store_v, 0, sizeof(point_store_t));
+
+	store_v->numberOfPoints = numberOfPoints;
+	store_v->dim = dim;
+	store_v->maxId = -1;
+	store_v->mapping = mapping;
+	store_v->mapping_size = mapping_size;
+	store_v->coord = (COORD_TYPE*)((char*)mapping + coord_offset);
+
+	store_v->rows = (point_t*)malloc((numberOfPoints > 0 ? numberOfPoints : 1) * sizeof(point_t));
+	for(int i = 0; i < numberOfPoints; i++)
+	{
+		store_v->rows[i].dim = dim;
+		store_v->rows[i].coord = store_v->coord + (size_t)i * dim;
+		store_v->rows[i].id = -1;
+	}
+
+	return store_v;
+}
+
+/*
+ *	Release memory for a point store, including its rows
+ */
+void release_point_store(point_store_t* &store_v)
+{
+	if(store_v == NULL)
+		return;
+
+	if(store_v->mapping != NULL)
+		munmap(store_v->mapping, store_v->mapping_size);
+	else
+	{
+		free(store_v->coord);
+		free(store_v->min);
+		free(store_v->max);
+	}
+	free(store_v->rows);
+	free(store_v->row_of);
+
+	free(store_v);
+	store_v = NULL;
+}
+
+/*
+ *	Build the id->row map of a point store from the ids of its rows
+ */
+void index_point_store(point_store_t* store_v)
+{
+	int maxId = -1;
+	for(int i = 0; i < store_v->numberOfPoints; i++)
+	{
+		if(store_v->rows[i].id > maxId)
+			maxId = store_v->rows[i].id;
+	}
+
+	free(store_v->row_of);
+	store_v->maxId = maxId;
+	store_v->row_of = (int*)malloc((maxId + 1 > 0 ? maxId + 1 : 1) * sizeof(int));
+	for(int id = 0; id <= maxId; id++)
+		store_v->row_of[id] = -1;
+
+	for(int i = 0; i < store_v->numberOfPoints; i++)
+	{
+		if(store_v->rows[i].id >= 0)
+			store_v->row_of[store_v->rows[i].id] = i;
+	}
+}
+
+/*
+ *	Return the row of the point with the given id, -1 if there is none
+ *	(the store has to be indexed by index_point_store)
+ */
+int point_store_row(point_store_t* store_v, int id)
+{
+	if(store_v == NULL || store_v->row_of == NULL || id < 0 || id > store_v->maxId)
+		return -1;
+
+	return store_v->row_of[id];
+}
+
+/*
+ *	Allocate a view of base projected onto the dimensions dims (in increasing order)
+ */
+projection_t* alloc_projection(point_set_t* base, const std::set<int>& dims)
+{
+	projection_t* projection_v;
+
+	projection_v = (projection_t*)malloc(sizeof(projection_t));
+	memset(projection_v, 0, sizeof(projection_t));
+
+	projection_v->base = base;
+	projection_v->dim = dims.size();
+	projection_v->dims = (int*)malloc((dims.size() > 0 ? dims.size() : 1) * sizeof(int));
+
+	int k = 0;
+	for (std::set<int>::const_iterator it = dims.begin(); it != dims.end(); ++it)
+		projection_v->dims[k++] = *it;
+
+	return projection_v;
+}
+
+/*
+ *	Release memory for a projection (the base point set is not released)
+ */
+void release_projection(projection_t* &projection_v)
+{
+	if (projection_v == NULL)
+		return;
+
+	free(projection_v->dims);
+	free(projection_v);
+	projection_v = NULL;
+}
+
+/*
+ *	Copy the projected coordinates of the base points rows[0..count-1] (all base points if rows is NULL)
+ *	into a new store-backed point set, keeping their ids
+ */
+point_set_t* project_points(projection_t* projection_v, const int* rows, int count)
+{
+	point_set_t* base = projection_v->base;
+	int dim = projection_v->dim;
+	const int* dims = projection_v->dims;
+	if (rows == NULL)
+		count = base->numberOfPoints;
+
+	point_set_t* point_set_v = alloc_point_set(count, dim);
+	for (int i = 0; i < count; i++)
+	{
+		point_t* b = base->points[rows == NULL ? i : rows[i]];
+		point_t* p = point_set_v->points[i];
+
+		p->id = b->id;
+		for (int k = 0; k < dim; k++)
+			p->coord[k] = b->coord[dims[k]];
+	}
+
+	return point_set_v;
+}
+
 /*
 *	For degug purpose, print the coordinates for a given point
 */
@@ -1,6 +1,7 @@
 #ifndef DATA_UTILITY_H
 #define DATA_UTILITY_H
 #include "data_struct.h"
+#include <set>
 
 // sort the 2d points clockwise
 struct angleCmp
@@ -20,7 +21,17 @@ point_t* alloc_point(int dim, int id);
 void release_point( point_t* &point_v);
 point_t* rand_point(int dim);
 point_set_t* alloc_point_set(int numberOfPoints);
+point_set_t* alloc_point_set(int numberOfPoints, int dim);
+point_set_t* alloc_point_set(point_store_t* store_v);
 void release_point_set(point_set_t* &point_set_v, bool clear);
+point_store_t* alloc_point_store(int numberOfPoints, int dim);
+point_store_t* map_point_store(int numberOfPoints, int dim, void* mapping, size_t mapping_size, size_t coord_offset);
+void release_point_store(point_store_t* &store_v);
+void index_point_store(point_store_t* store_v);
+int point_store_row(point_store_t* store_v, int id);
+projection_t* alloc_projection(point_set_t* base, const std::set<int>& dims);
+void release_projection(projection_t* &projection_v);
+point_set_t* project_points(projection_t* projection_v, const int* rows, int count);
 hyperplane_t* alloc_hyperplane(point_t* normal, double offset);
 void release_hyperplane(hyperplane_t* &hyperplane_v);
 
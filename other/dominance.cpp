@@ -0,0 +1,154 @@
+#include "dominance.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DOMINANCE_X86
+#endif
+
+// check whether p1 dominates p2, scalar
+static int dominates_scalar(const COORD_TYPE* p1, const COORD_TYPE* p2, int dim)
+{
+	for (int i = 0; i < dim; ++i)
+		if (p1[i] < p2[i])
+			return 0;
+	return 1;
+}
+
+#ifdef DOMINANCE_X86
+// check whether p1 dominates p2, 4 dimensions at a time
+__attribute__((target("avx2")))
+static int dominates_avx2(const COORD_TYPE* p1, const COORD_TYPE* p2, int dim)
+{
+	int i = 0;
+	for (; i + 4 <= dim; i += 4)
+	{
+		__m256d lt = _mm256_cmp_pd(_mm256_loadu_pd(p1 + i), _mm256_loadu_pd(p2 + i), _CMP_LT_OQ);
+		if (_mm256_movemask_pd(lt))
+			return 0;
+	}
+	for (; i < dim; ++i)
+		if (p1[i] < p2[i])
+			return 0;
+	return 1;
+}
+
+// check whether p1 dominates p2, 8 dimensions at a time (the tail is masked)
+__attribute__((target("avx512f")))
+static int dominates_avx512(const COORD_TYPE* p1, const COORD_TYPE* p2, int dim)
+{
+	int i = 0;
+	for (; i + 8 <= dim; i += 8)
+	{
+		if (_mm512_cmp_pd_mask(_mm512_loadu_pd(p1 + i), _mm512_loadu_pd(p2 + i), _CMP_LT_OQ))
+			return 0;
+	}
+	if (i < dim)
+	{
+		__mmask8 tail = (__mmask8)((1u << (dim - i)) - 1);
+		if (_mm512_mask_cmp_pd_mask(tail, _mm512_maskz_loadu_pd(tail, p1 + i), _mm512_maskz_loadu_pd(tail, p2 + i), _CMP_LT_OQ))
+			return 0;
+	}
+	return 1;
+}
+
+// compare pt against 4 window points per step, one dimension at a time across the points;
+// bit j is set if rows[idx[j]] dominates pt (or pt dominates rows[idx[j]] if reverse is set)
+__attribute__((target("avx2")))
+static uint64_t block_mask_avx2(const COORD_TYPE* pt, const COORD_TYPE* const* rows, const int* idx, int count, int dim, bool reverse)
+{
+	uint64_t mask = 0;
+	int j = 0;
+	for (; j + 4 <= count; j += 4)
+	{
+		__m256i base = _mm256_set_epi64x((long long)rows[idx[j + 3]], (long long)rows[idx[j + 2]], (long long)rows[idx[j + 1]], (long long)rows[idx[j]]);
+		__m256d lt = _mm256_setzero_pd();
+		for (int k = 0; k < dim; ++k)
+		{
+			__m256i addr = _mm256_add_epi64(base, _mm256_set1_epi64x(k * (long long)sizeof(COORD_TYPE)));
+			__m256d v = _mm256_i64gather_pd((const double*)0, addr, 1);
+			__m256d p = _mm256_set1_pd(pt[k]);
+			lt = _mm256_or_pd(lt, reverse ? _mm256_cmp_pd(p, v, _CMP_LT_OQ) : _mm256_cmp_pd(v, p, _CMP_LT_OQ));
+			if (_mm256_movemask_pd(lt) == 0xF)
+				break;
+		}
+		mask |= (uint64_t)(~_mm256_movemask_pd(lt) & 0xF) << j;
+	}
+	for (; j < count; ++j)
+	{
+		int d = reverse ? dominates_avx2(pt, rows[idx[j]], dim) : dominates_avx2(rows[idx[j]], pt, dim);
+		mask |= (uint64_t)d << j;
+	}
+	return mask;
+}
+#endif
+
+typedef int (*dominates_fn)(const COORD_TYPE*, const COORD_TYPE*, int);
+typedef uint64_t (*block_fn)(const COORD_TYPE*, const COORD_TYPE* const*, const int*, int, int, bool);
+
+// the kernels for this CPU
+struct dominance_kernels
+{
+	const char* name;
+	dominates_fn pair;		// one pair, vectorized across the dimensions
+	block_fn block;			// a block of window points, vectorized across the points (NULL if unavailable)
+};
+
+static dominance_kernels select_kernels()
+{
+	dominance_kernels k = {"scalar", dominates_scalar, NULL};
+#ifdef DOMINANCE_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+	{
+		k.name = "avx2";
+		k.pair = dominates_avx2;
+		k.block = block_mask_avx2;
+	}
+	if (__builtin_cpu_supports("avx512f"))
+	{
+		k.name = "avx512";
+		k.pair = dominates_avx512;
+	}
+#endif
+	return k;
+}
+
+static const dominance_kernels kernels = select_kernels();
+
+// bit j is set if rows[idx[j]] dominates pt (or pt dominates rows[idx[j]] if reverse is set)
+static uint64_t block_mask(const COORD_TYPE* pt, const COORD_TYPE* const* rows, const int* idx, int count, int dim, bool reverse)
+{
+	// with few dimensions a pair is too short to fill a vector, so compare across the window points instead
+	if (dim < DOMINANCE_ACROSS_DIM && kernels.block != NULL)
+		return kernels.block(pt, rows, idx, count, dim, reverse);
+
+	dominates_fn f = kernels.pair;
+	uint64_t mask = 0;
+	for (int j = 0; j < count; ++j)
+		mask |= (uint64_t)(reverse ? f(pt, rows[idx[j]], dim) : f(rows[idx[j]], pt, dim)) << j;
+	return mask;
+}
+
+// check whether p1 dominates p2
+int dominates_rows(const COORD_TYPE* p1, const COORD_TYPE* p2, int dim)
+{
+	return kernels.pair(p1, p2, dim);
+}
+
+// bit j of the result is set if rows[idx[j]] dominates pt, for j < count <= DOMINANCE_BLOCK
+uint64_t dominated_by_mask(const COORD_TYPE* pt, const COORD_TYPE* const* rows, const int* idx, int count, int dim)
+{
+	return block_mask(pt, rows, idx, count, dim, false);
+}
+
+// bit j of the result is set if pt dominates rows[idx[j]], for j < count <= DOMINANCE_BLOCK
+uint64_t dominates_mask(const COORD_TYPE* pt, const COORD_TYPE* const* rows, const int* idx, int count, int dim)
+{
+	return block_mask(pt, rows, idx, count, dim, true);
+}
+
+// name of the kernel in use ("avx512", "avx2" or "scalar")
+const char* dominance_kernel()
+{
+	return kernels.name;
+}
@@ -0,0 +1,29 @@
+#ifndef DOMINANCE_H
+#define DOMINANCE_H
+
+#include "data_struct.h"
+#include <stdint.h>
+
+// maximum number of window points compared in one call (one bit each in the result)
+#define DOMINANCE_BLOCK 64
+
+// below this many dimensions, blocks are compared across the window points rather than across the dimensions
+#define DOMINANCE_ACROSS_DIM 8
+
+// dominance kernels, compared on coordinate rows: p1 dominates p2 if p1[k] >= p2[k] in every dimension k.
+// The kernels are vectorized with AVX-512 or AVX2 when the CPU supports it, chosen once at run time,
+// and fall back to scalar code otherwise.
+
+// check whether p1 dominates p2
+int dominates_rows(const COORD_TYPE* p1, const COORD_TYPE* p2, int dim);
+
+// bit j of the result is set if rows[idx[j]] dominates pt, for j < count <= DOMINANCE_BLOCK
+uint64_t dominated_by_mask(const COORD_TYPE* pt, const COORD_TYPE* const* rows, const int* idx, int count, int dim);
+
+// bit j of the result is set if pt dominates rows[idx[j]], for j < count <= DOMINANCE_BLOCK
+uint64_t dominates_mask(const COORD_TYPE* pt, const COORD_TYPE* const* rows, const int* idx, int count, int dim);
+
+// name of the kernel in use ("avx512", "avx2" or "scalar")
+const char* dominance_kernel();
+
+#endif // DOMINANCE_H
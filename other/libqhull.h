@@ -406,7 +406,7 @@ struct vertexT {
    qhmem may be shared across multiple instances of Qhull.
    Rbox uses global variables rbox_inuse and rbox, but does not persist data across calls.
 
-   Qhull is not multithreaded.  Global state could be stored in thread-local storage.
+   Qhull is not multithreaded.  Global state is stored in thread-local storage (qh_THREADLOCAL in user.h).
 */
 
 extern int qhull_inuse;
@@ -417,13 +417,13 @@ typedef struct qhT qhT;
 __declspec(dllimport) extern qhT *qh_qh;     /* allocated in global.c */
 #elif qh_QHpointer
 #define qh qh_qh->
-extern qhT *qh_qh;     /* allocated in global.c */
+extern qh_THREADLOCAL qhT *qh_qh;     /* allocated in global.c */
 #elif qh_dllimport
 #define qh qh_qh.
 __declspec(dllimport) extern qhT qh_qh;      /* allocated in global.c */
 #else
 #define qh qh_qh.
-extern qhT qh_qh;
+extern qh_THREADLOCAL qhT qh_qh;
 #endif
 
 struct qhT {
@@ -1,6 +1,7 @@
 //#include "stdAfx.h"
 
 #include "lp.h"
+#include "simplex.h"
 #include <set>
 #include <ctime>
 #include <vector>
@@ -8,6 +9,8 @@
 #include <cstdio>
 #include <cmath>
 #include <random>
+#include <thread>
+#include <algorithm>
 
 //#define DEBUG_LP
 
@@ -34,12 +37,142 @@
 */
 
 
+/*
+ * The LPs below on the dense simplex of simplex.h, which solves these small problems without GLPK's setup.
+ * Each returns false if the problem is too large for it or its solution is unreliable, in which case
+ * the caller solves it with GLPK.
+ */
+
+// pt = sum_j w_j ExRays[j] for some w >= 0
+static bool dense_inside_cone(std::vector<point_t*>& ExRays, point_t* pt, bool& inside)
+{
+	int M = ExRays.size();
+	int D = pt->dim;
+	if (!fits_dense_lp(D, M))
+		return false;
+
+	static thread_local dense_lp_t lp;
+	init_dense_lp(lp, D, M, true);
+	for (int i = 0; i < D; i++)
+	{
+		lp.row_type[i] = SIMPLEX_EQ;
+		lp.b[i] = pt->coord[i];
+		for (int j = 0; j < M; j++)
+			lp.A[i * M + j] = ExRays[j]->coord[i];
+	}
+
+	int status = solve_dense_lp(lp);
+	if (status != SIMPLEX_OPT && status != SIMPLEX_INFEAS)
+		return false;
+	inside = status == SIMPLEX_OPT;
+	return true;
+}
+
+// max y[D+1] s.t. normal_i y[0..D-1] + offset_i y[D] + y[D+1] <= 0, y[D] >= 0, y[D+1] <= D+1
+static bool dense_find_feasible(std::vector<hyperplane_t*>& hyperplane, std::vector<double>& y)
+{
+	int M = hyperplane.size();
+	int D = hyperplane[0]->normal->dim;
+	if (!fits_dense_lp(M, D + 2))
+		return false;
+
+	static thread_local dense_lp_t lp;
+	init_dense_lp(lp, M, D + 2, true);
+	for (int j = 0; j < D; j++)
+		lp.col_type[j] = SIMPLEX_FR;
+	lp.col_type[D + 1] = SIMPLEX_UP;
+	lp.ub[D + 1] = D + 1;
+	lp.c[D + 1] = 1;
+	for (int i = 0; i < M; i++)
+	{
+		double* row = &lp.A[i * (D + 2)];
+		for (int j = 0; j < D; j++)
+			row[j] = hyperplane[i]->normal->coord[j];
+		row[D] = hyperplane[i]->offset;
+		row[D + 1] = 1;
+	}
+
+	if (solve_dense_lp(lp) != SIMPLEX_OPT)
+		return false;
+	y = lp.x;
+	return true;
+}
+
+// min theta s.t. -theta mean + sum_j lambda_j B[j] = b, theta, lambda >= 0, with the row duals in pi
+static bool dense_solveLP(std::vector<point_t*>& B, point_t* mean, point_t* b, double& theta, point_t* pi)
+{
+	int M = B.size() + 1;
+	int D = b->dim;
+	if (!fits_dense_lp(D, M))
+		return false;
+
+	static thread_local dense_lp_t lp;
+	init_dense_lp(lp, D, M, false);
+	lp.c[0] = 1;
+	for (int i = 0; i < D; i++)
+	{
+		lp.row_type[i] = SIMPLEX_EQ;
+		lp.b[i] = b->coord[i];
+		lp.A[i * M] = -mean->coord[i];
+		for (int j = 1; j < M; j++)
+			lp.A[i * M + j] = B[j - 1]->coord[i];
+	}
+
+	if (solve_dense_lp(lp) != SIMPLEX_OPT)
+		return false;
+	theta = lp.obj;
+	for (int i = 0; i < D; i++)
+		pi->coord[i] = lp.dual[i];
+	return true;
+}
+
+// the MRR LP described above, on the first K points of s
+static bool dense_worst_direction(int K, point_set_t* s, point_t* pt, double* v, double& regret_ratio)
+{
+	int D = pt->dim;
+	double epsilon = 0.0000000000001;
+	if (K == 0 || !fits_dense_lp(K + 2, D + 1))
+		return false;
+
+	static thread_local dense_lp_t lp;
+	init_dense_lp(lp, K + 2, D + 1, true);
+	lp.col_type[D] = SIMPLEX_FR;
+	lp.c[D] = 1;
+	for (int i = 0; i < K; i++)
+	{
+		double* row = &lp.A[i * (D + 1)];
+		for (int j = 0; j < D; j++)
+			row[j] = -(pt->coord[j] - s->points[i]->coord[j]);
+		row[D] = 1;
+	}
+	double* r1 = &lp.A[K * (D + 1)];
+	double* r2 = &lp.A[(K + 1) * (D + 1)];
+	for (int j = 0; j < D; j++)
+	{
+		r1[j] = pt->coord[j];
+		r2[j] = -pt->coord[j];
+	}
+	lp.b[K] = 1.0 + epsilon;
+	lp.b[K + 1] = -1.0 + epsilon;
+
+	if (solve_dense_lp(lp) != SIMPLEX_OPT)
+		return false;
+	regret_ratio = lp.obj;
+	for (int j = 0; j < D; j++)
+		v[j] = lp.x[j];
+	return true;
+}
+
 // Use LP to check whehter a point pt is a conical combination of the vectors in ExRays
 bool insideCone(std::vector<point_t*> ExRays, point_t* pt)
 {
 	int M = ExRays.size();
 	int D = pt->dim;
 
+	bool inside;
+	if (dense_inside_cone(ExRays, pt, inside))
+		return inside;
+
 	int* ia = new int[1 + D * M];  //TODO: delete
 	int* ja = new int[1 + D * M];  //TODO: delete
 	double* ar = new double[1 + D * M];   //TODO: delete
@@ -126,6 +259,20 @@ point_t* find_feasible(std::vector<hyperplane_t*> hyperplane)
 	int M = hyperplane.size();
 	int D = hyperplane[0]->normal->dim;
 
+	std::vector<double> y;
+	if (dense_find_feasible(hyperplane, y))
+	{
+		if (y[D] < 0 || isZero(y[D]))
+		{
+			fprintf(stderr, "LP feasible error.\n");
+			return NULL;
+		}
+		point_t* feasible_pt = alloc_point(D);
+		for (int i = 0; i < D; i++)
+			feasible_pt->coord[i] = y[i] / y[D];
+		return feasible_pt;
+	}
+
 	// D + 2variables: D for dim, 2 for additional var for feasible
 	int* ia = new int[1 + (D + 2) * M];  //TODO: delete
 	int* ja = new int[1 + (D + 2) * M];  //TODO: delete
@@ -215,7 +362,7 @@ point_t* find_feasible(std::vector<hyperplane_t*> hyperplane)
 
 	if(w1 < 0 || w2 < 0 || isZero(w1) || isZero(w2))
 	{
-		printf("LP feasible error.\n");
+		fprintf(stderr, "LP feasible error.\n");
 		return NULL;
 	}
 	for (i = 0; i < D; i++)
@@ -261,6 +408,12 @@ void solveLP(std::vector<point_t*> B, point_t* b, double& theta, point_t* & pi)
 	for(int i = 0; i < D; i++)
 		mean->coord[i] /= B.size();
 
+	if (dense_solveLP(B, mean, b, theta, pi))
+	{
+		release_point(mean);
+		return;
+	}
+
 	int* ia = new int[1 + D * M];  //TODO: delete
 	int* ja = new int[1 + D * M];  //TODO: delete
 	double* ar = new double[1 + D * M];   //TODO: delete
@@ -410,6 +563,10 @@ double worstDirection(point_set_t *s, point_t* pt, double* &v)
 	int K = s->numberOfPoints;
 	int D = pt->dim;
 
+	double dense_ratio;
+	if (dense_worst_direction(K, s, pt, v, dense_ratio))
+		return dense_ratio;
+
     int* ia = new int[1+(K+5)*(D+5)];  //TODO: delete
 	int* ja = new int[1+(K+5)*(D+5)];  //TODO: delete
     double* ar = new double[1+(K+5)*(D+5)];   //TODO: delete
@@ -535,11 +692,59 @@ double worstDirection(point_set_t *s, point_t* pt, double* &v)
 	
     return regret_ratio; 
 }    
+double worstDirection(worst_direction_lp_t& wlp, int index, point_set_t *s, point_t* pt, double* v)
+{
+	int D = pt->dim;
+	double epsilon = 0.0000000000001;
+	incremental_lp_t& ilp = wlp.lp;
+	static thread_local std::vector<double> row;
+	row.assign(D + 1, 0);
+
+	// the rows bounding the utility of pt, as in the LP above
+	if (wlp.K == 0 || wlp.K > index)
+	{
+		init_incremental_lp(ilp, D + 1, true, index + 2);
+		ilp.lp.col_type[D] = SIMPLEX_FR;
+		ilp.lp.c[D] = 1;
+		for (int j = 0; j < D; j++)
+			row[j] = pt->coord[j];
+		add_incremental_row(ilp, row.data(), 1.0 + epsilon);
+		for (int j = 0; j < D; j++)
+			row[j] = -pt->coord[j];
+		add_incremental_row(ilp, row.data(), -1.0 + epsilon);
+		wlp.K = 0;
+	}
+
+	// a row per point added to s
+	row[D] = 1;
+	for (; wlp.K < index; wlp.K++)
+	{
+		for (int j = 0; j < D; j++)
+			row[j] = -(pt->coord[j] - s->points[wlp.K]->coord[j]);
+		add_incremental_row(ilp, row.data(), 0);
+	}
+
+	if (index > 0 && solve_incremental_lp(ilp) == SIMPLEX_OPT)
+	{
+		for (int j = 0; j < D; j++)
+			v[j] = ilp.lp.x[j];
+		return ilp.lp.obj;
+	}
+
+	// too large or unreliable for the dense simplex: start over at the next call
+	wlp.K = 0;
+	return worstDirection(index, s, pt, v);
+}
+
 double worstDirection(int index, point_set_t *s, point_t* pt, double* &v)
 {
 	int K = index;
 	int D = pt->dim;
 
+	double dense_ratio;
+	if (dense_worst_direction(K, s, pt, v, dense_ratio))
+		return dense_ratio;
+
     int* ia = new int[1+(K+5)*(D+5)];  //TODO: delete
 	int* ja = new int[1+(K+5)*(D+5)];  //TODO: delete
     double* ar = new double[1+(K+5)*(D+5)];   //TODO: delete
@@ -670,6 +875,15 @@ double worstDirection(int index, point_set_t *s, point_t* pt, float* &v)
 	int K = index;
 	int D = pt->dim;
 
+	double dense_ratio;
+	std::vector<double> dense_v(D);
+	if (dense_worst_direction(K, s, pt, dense_v.data(), dense_ratio))
+	{
+		for (int i = 0; i < D; i++)
+			v[i] = dense_v[i];
+		return dense_ratio;
+	}
+
     int* ia = new int[1+(K+5)*(D+5)];  //TODO: delete
 	int* ja = new int[1+(K+5)*(D+5)];  //TODO: delete
     double* ar = new double[1+(K+5)*(D+5)];   //TODO: delete
@@ -924,46 +1138,173 @@ void test2(){
 /*
 * Compute the MRR of a given set of points
 */
-double evaluateLP(point_set_t *p, point_set_t* S, int VERBOSE)
+// Number of threads used by evaluateLP: the EVALUATE_THREADS environment variable if set, else the number of cores
+int evaluate_threads()
+{
+	const char* env = getenv("EVALUATE_THREADS");
+	if (env != NULL && atoi(env) > 0)
+		return atoi(env);
+
+	int cores = std::thread::hardware_concurrency();
+	return cores > 0 ? cores : 1;
+}
+
+// the coordinates of some points on some dimensions, stored by dimension so that utilities are computed column by column
+typedef struct column_matrix
+{
+	int					n;
+	int					dim;
+	std::vector<double>	col;	// col[k * n + i]: coordinate k of point i
+
+}	column_matrix_t;
+
+// the points of p restricted to the dimensions dims
+static void fill_columns(column_matrix_t& m, point_set_t* p, const std::vector<int>& dims)
+{
+	m.n = p->numberOfPoints;
+	m.dim = dims.size();
+	m.col.resize((size_t)m.n * m.dim);
+	for (int k = 0; k < m.dim; k++)
+	{
+		double* c = &m.col[(size_t)k * m.n];
+		for (int i = 0; i < m.n; i++)
+			c[i] = p->points[i]->coord[dims[k]];
+	}
+}
+
+// utility of maxPoint(p, v) for the points p of m: the utilities are accumulated a block of points at a time, one dimension after the other
+static double max_utility(const column_matrix_t& m, const double* v)
+{
+	const int block = 256;
+	double score[block];
+	double first = 0, best = 0;
+
+	for (int start = 0; start < m.n; start += block)
+	{
+		int len = std::min(block, m.n - start);
+		for (int i = 0; i < len; i++)
+			score[i] = 0;
+		for (int k = 0; k < m.dim; k++)
+		{
+			const double* c = &m.col[(size_t)k * m.n + start];
+			double vk = v[k];
+			for (int i = 0; i < len; i++)
+				score[i] += vk * c[i];
+		}
+
+		if (start == 0)
+			first = score[0];
+		for (int i = 0; i < len; i++)
+			best = std::max(best, score[i]);
+	}
+
+	// maxPoint returns the first point when no utility is positive
+	return best > 0 ? best : first;
+}
+
+/*
+ * Largest regret ratio of S over the worst directions of the points of p on the dimensions dims
+ * (directions scaled to unit length if normalize is set). The LPs of the points are split over
+ * evaluate_threads() threads; the direction of the first point reaching the maximum is written to v_max.
+ */
+static double max_regret_ratio(point_set_t* p, point_set_t* S, const std::vector<int>& dims, bool normalize, double* v_max)
 {
-	int D = p->points[0]->dim;
 	int N = p->numberOfPoints;
-	int K = S->numberOfPoints;
+	int d = dims.size();
 
-	int i, j;
-	double maxRegret = 0.0, maxK, maxN;
-	double* v = new double[D];
-    double min_dot = 1;
+	column_matrix_t P_cols, S_cols;
+	fill_columns(P_cols, p, dims);
+	fill_columns(S_cols, S, dims);
 
-	for (i = 0; i < N; ++i)
+	// S on the dimensions dims, as the rows of the LPs
+	point_set_t* S_prime = alloc_point_set(S->numberOfPoints, d);
+	for (int j = 0; j < S->numberOfPoints; j++)
 	{
-		// obtain the worst utility vector v
-		worstDirection(S, p->points[i], v);
+		S_prime->points[j]->id = S->points[j]->id;
+		for (int k = 0; k < d; k++)
+			S_prime->points[j]->coord[k] = S->points[j]->coord[dims[k]];
+	}
 
-		maxN = dot_prod(maxPoint(p, v), v);
-		maxK = dot_prod(maxPoint(S, v), v);
+	int shards = std::max(1, std::min(evaluate_threads(), N / EVALUATE_MIN_SHARD));
+	std::vector<double> shard_regret(shards, 0.0);
+	std::vector<double> shard_v((size_t)shards * d, 0.0);
 
-		if (1.0 - maxK / maxN > maxRegret)
-			maxRegret = 1.0 - maxK / maxN;
-        
-        // normalize v to be unit vector
-        // double norm_v = 0.0;
-        // for (int k = 0; k < D; ++k){
-        //     norm_v += v[k] * v[k];
-        // }
-        // norm_v = sqrt(norm_v);
-        // for (int k = 0; k < D; ++k){
-        //     v[k] = v[k] / norm_v;
-        // }
-        //check if the norm of point is zero
-        // double dot = dot_prod(p->points[i], p->points[i]);
-        // if (dot < 0.0000000001) printf("point %d has zero norm\n", i);
+	auto evaluate = [&](int s)
+	{
+		point_t* pt = alloc_point(d);
+		double* v = new double[d];
+		double* best_v = &shard_v[(size_t)s * d];
+
+		for (int j = (int)((long long)N * s / shards); j < (int)((long long)N * (s + 1) / shards); j++)
+		{
+			pt->id = p->points[j]->id;
+			for (int k = 0; k < d; k++)
+				pt->coord[k] = p->points[j]->coord[dims[k]];
+
+			// obtain the worst utility vector v
+			worstDirection(S_prime, pt, v);
+
+			if (normalize)
+			{
+				double norm_v = 0.0;
+				for (int k = 0; k < d; k++)
+					norm_v += v[k] * v[k];
+				norm_v = sqrt(norm_v);
+				for (int k = 0; k < d; k++)
+					v[k] = v[k] / norm_v;
+			}
+
+			double maxN = max_utility(P_cols, v);
+			double maxK = max_utility(S_cols, v);
+			if (1.0 - maxK / maxN > shard_regret[s])
+			{
+				shard_regret[s] = 1.0 - maxK / maxN;
+				std::copy(v, v + d, best_v);
+			}
+		}
+
+		delete[] v;
+		release_point(pt);
+	};
+
+	std::vector<std::thread> threads;
+	for (int s = 1; s < shards; s++)
+		threads.push_back(std::thread([&, s]
+		{
+			evaluate(s);
+			glp_free_env(); // the GLPK environment of this thread, used if an LP fell back to GLPK
+		}));
+	evaluate(0);
+	for (size_t t = 0; t < threads.size(); t++)
+		threads[t].join();
+	release_point_set(S_prime, true);
+
+	// shards cover increasing ranges of points, so a strictly larger ratio keeps the first point reaching the maximum
+	double maxRegret = 0.0;
+	for (int s = 0; s < shards; s++)
+	{
+		if (shard_regret[s] > maxRegret)
+		{
+			maxRegret = shard_regret[s];
+			if (v_max != NULL)
+				std::copy(&shard_v[(size_t)s * d], &shard_v[(size_t)s * d] + d, v_max);
+		}
 	}
+	return maxRegret;
+}
+
+double evaluateLP(point_set_t *p, point_set_t* S, int VERBOSE)
+{
+	int D = p->points[0]->dim;
+
+	std::vector<int> dims(D);
+	for (int k = 0; k < D; k++)
+		dims[k] = k;
+	double maxRegret = max_regret_ratio(p, S, dims, false, NULL);
 
 	if (VERBOSE)
 		printf("LP max regret ratio = %lf\n", maxRegret);
 
-	delete[]v;
 	return maxRegret;
 }
 
@@ -980,17 +1321,148 @@ double evaluateLP(point_set_t *p, point_set_t* S, int VERBOSE, point_t* u){
     if (VERBOSE)
         printf("regret ratio based on ground truth: %lf\n", maxRegret);
 
-	delete[]v;
-	return maxRegret;
+    delete[]v;
+    return maxRegret;
+}
+
+/*
+ * best[m] = max(best[m], max_i p_i . u_m) over the points p_i = rows[i] on the dimensions dims, for the
+ * MC_BLOCK utility vectors of ut (ut[k * MC_BLOCK + m] is coordinate k of u_m). Like a matrix product,
+ * four points times eight utility vectors are accumulated in registers, each coordinate broadcast
+ * along the vectors; pc holds the coordinates of the four points, 4 * dims.size() of them.
+ */
+static inline __attribute__((always_inline)) void max_utility_block_body(point_t* const* rows, int count, const std::vector<int>& dims, const double* ut, double* best, double* pc)
+{
+	int d = dims.size();
+
+	for (int i = 0; i < count; i += 4)
+	{
+		// a missing fourth point repeats the last one, which leaves the maxima unchanged
+		for (int k = 0; k < d; k++)
+			for (int q = 0; q < 4; q++)
+				pc[k * 4 + q] = rows[std::min(i + q, count - 1)]->coord[dims[k]];
+
+		for (int m0 = 0; m0 < MC_BLOCK; m0 += 8)
+		{
+			double acc[4][8] = {};
+			for (int k = 0; k < d; k++)
+			{
+				const double* u = ut + k * MC_BLOCK + m0;
+				for (int q = 0; q < 4; q++)
+				{
+					double a = pc[k * 4 + q];
+					for (int m = 0; m < 8; m++)
+						acc[q][m] += a * u[m];
+				}
+			}
+			for (int m = 0; m < 8; m++)
+				best[m0 + m] = std::max(best[m0 + m], std::max(std::max(acc[0][m], acc[1][m]), std::max(acc[2][m], acc[3][m])));
+		}
+	}
+}
+
+typedef void (*max_utility_block_fn)(point_t* const* rows, int count, const std::vector<int>& dims, const double* ut, double* best, double* pc);
+
+static void max_utility_block_scalar(point_t* const* rows, int count, const std::vector<int>& dims, const double* ut, double* best, double* pc)
+{
+	max_utility_block_body(rows, count, dims, ut, best, pc);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// the same kernel compiled for AVX2, used when the CPU supports it
+__attribute__((target("avx2,fma")))
+static void max_utility_block_avx2(point_t* const* rows, int count, const std::vector<int>& dims, const double* ut, double* best, double* pc)
+{
+	max_utility_block_body(rows, count, dims, ut, best, pc);
+}
+#endif
+
+static max_utility_block_fn select_max_utility_block()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		return max_utility_block_avx2;
+#endif
+	return max_utility_block_scalar;
+}
+
+static const max_utility_block_fn max_utility_block = select_max_utility_block();
+
+// best[m] = max_i p_i . u_m over all points of p, streamed MC_CHUNK points at a time through every block of utility vectors
+static void max_utility_mc(point_set_t* p, const std::vector<int>& dims, const std::vector<double>& ut, int blocks, std::vector<double>& best)
+{
+	int d = dims.size();
+	std::vector<double> pc(4 * d);
+	best.assign((size_t)blocks * MC_BLOCK, 0.0);
+	for (int start = 0; start < p->numberOfPoints; start += MC_CHUNK)
+	{
+		int count = std::min(MC_CHUNK, p->numberOfPoints - start);
+		for (int b = 0; b < blocks; b++)
+			max_utility_block(p->points + start, count, dims, &ut[(size_t)b * d * MC_BLOCK], &best[(size_t)b * MC_BLOCK], pc.data());
+	}
+}
+
+regret_estimate_t evaluateMC(point_set_t *p, point_set_t* S, int VERBOSE, int M, std::set<int> dims)
+{
+	std::vector<int> dimension_indices(dims.begin(), dims.end());
+	if (dimension_indices.empty())
+		for (int k = 0; k < p->points[0]->dim; k++)
+			dimension_indices.push_back(k);
+	int d = dimension_indices.size();
+	int blocks = (M + MC_BLOCK - 1) / MC_BLOCK;
+
+	// utility vectors uniform on the simplex (normalized exponential variables), stored block by block and
+	// dimension by dimension; the padding of the last block stays 0
+	std::random_device rd;
+	std::mt19937 generator(rd());
+	std::exponential_distribution<double> distribution(1.0);
+	std::vector<double> ut((size_t)blocks * d * MC_BLOCK, 0.0);
+	for (int m = 0; m < M; m++)
+	{
+		double* u = &ut[(size_t)(m / MC_BLOCK) * d * MC_BLOCK + m % MC_BLOCK];
+		double sum = 0;
+		for (int k = 0; k < d; k++)
+		{
+			u[k * MC_BLOCK] = distribution(generator);
+			sum += u[k * MC_BLOCK];
+		}
+		for (int k = 0; k < d; k++)
+			u[k * MC_BLOCK] /= sum;
+	}
+
+	std::vector<double> maxN, maxK;
+	max_utility_mc(p, dimension_indices, ut, blocks, maxN);
+	max_utility_mc(S, dimension_indices, ut, blocks, maxK);
+
+	regret_estimate_t estimate;
+	estimate.samples = M;
+	estimate.max = 0;
+	double sum = 0, sum_sq = 0;
+	for (int m = 0; m < M; m++)
+	{
+		double rr = maxN[m] > 0 ? 1.0 - maxK[m] / maxN[m] : 0;
+		estimate.max = std::max(estimate.max, rr);
+		sum += rr;
+		sum_sq += rr * rr;
+	}
+	estimate.mean = sum / M;
+	double variance = M > 1 ? std::max(0.0, (sum_sq - sum * sum / M) / (M - 1)) : 0;
+	estimate.mean_error = 1.96 * sqrt(variance / M);
+	// the sample maximum misses a fraction t of the utility vectors with probability (1 - t)^M <= exp(-t M)
+	estimate.tail = log(20.0) / M;
+
+	if (VERBOSE)
+		printf("MC max regret ratio = %lf, mean = %lf +- %lf over %d utility vectors\n", estimate.max, estimate.mean, estimate.mean_error, M);
+
+	return estimate;
 }
 
 double evaluateLP(point_set_t *p, point_set_t* S, int VERBOSE, int d, std::set<int> final_dimensions, int test_rounds)//use random sampling
 {
     int D = p->points[0]->dim;
-    int N = p->numberOfPoints;
-    int K = S->numberOfPoints;
 
-    int i, j;
+    int i;
     double maxRegret = 0.0, maxK, maxN;
     // number of random tests conducted in the evaluation process, set to a value s.t. the mrr is stable
     int round = test_rounds;
@@ -1016,65 +1488,21 @@ double evaluateLP(point_set_t *p, point_set_t* S, int VERBOSE, int d, std::set<i
         }
         std::vector<int> dimension_indices(selected_dimensions.begin(), selected_dimensions.end());
 
-        // Construct reduced-dimension subsets
-        point_set_t* S_prime = alloc_point_set(K);
-        for (j = 0; j < K; ++j){
-            S_prime->points[j] = alloc_point(d);
-            S_prime->points[j]->id = S->points[j]->id; // Preserve the ID
-            for (int k = 0; k < d; ++k){
-                S_prime->points[j]->coord[k] = S->points[j]->coord[dimension_indices[k]];
-            }
-        }
-
-        point_set_t* P_prime = alloc_point_set(N);
-        for (j = 0; j < N; ++j){
-            P_prime->points[j] = alloc_point(d);
-            P_prime->points[j]->id = p->points[j]->id; // Preserve the ID
-            for (int k = 0; k < d; ++k){
-                P_prime->points[j]->coord[k] = p->points[j]->coord[dimension_indices[k]];
-            }
-        }
-
-        double maxRegret_round = 0.0;
+        // the LPs and utilities of the round are computed on the selected dimensions of p and S directly
+        double maxRegret_round = max_regret_ratio(p, S, dimension_indices, true, v);
+        mrr_list.push_back(maxRegret_round);
 
-        // Find worst direction for each point
-        for (j = 0; j < N; ++j){
-            worstDirection(S_prime, P_prime->points[j], v);
-            
-            // Normalize v to unit vector
-            double norm_v = 0.0;
-            for (int k = 0; k < d; ++k){
-                norm_v += v[k] * v[k];
+        if (maxRegret_round > maxRegret){
+            maxRegret = maxRegret_round;
+            // Reset inspect_v
+            for (int k = 0; k < D; ++k){
+                inspect_v[k] = 0;
             }
-            norm_v = sqrt(norm_v);
+            // Map reduced dimensions back to original space
             for (int k = 0; k < d; ++k){
-                v[k] = v[k] / norm_v;
-            }
-
-            maxN = dot_prod(maxPoint(P_prime, v), v);
-            maxK = dot_prod(maxPoint(S_prime, v), v);
-
-            if (1.0 - maxK / maxN > maxRegret_round){
-                maxRegret_round = 1.0 - maxK / maxN;
-            }
-            
-            if (1.0 - maxK / maxN > maxRegret){
-                maxRegret = 1.0 - maxK / maxN;
-                // Reset inspect_v
-                for (int k = 0; k < D; ++k){
-                    inspect_v[k] = 0;
-                }
-                // Map reduced dimensions back to original space
-                for (int k = 0; k < d; ++k){
-                    inspect_v[dimension_indices[k]] = v[k];
-                }
+                inspect_v[dimension_indices[k]] = v[k];
             }
         }
-        mrr_list.push_back(maxRegret_round);
-
-
-        release_point_set(S_prime, 1);
-        release_point_set(P_prime, 1);
     }
     // Calculate the average MRR from all rounds
     double average_mrr = 0.0;
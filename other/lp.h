@@ -6,9 +6,10 @@
 #include "data_struct.h"
 #include "data_utility.h"
 #include "operation.h"
+#include "simplex.h"
 #include <vector>
 
-// solve LP using GLPK
+// solve LP using GLPK, or the dense simplex of simplex.h for small problems
 
 // Use LP to check whehter a point pt is a conical combination of the vectors in ExRays
 bool insideCone(std::vector<point_t*> ExRays, point_t* pt);
@@ -25,12 +26,31 @@ void solveLP(std::vector<point_t*> B, point_t* b, double& theta, point_t* & pi);
 double worstDirection(point_set_t *s, point_t* pt, double* &v);
 double worstDirection(int index, point_set_t *s, point_t* pt, double* &v);
 double worstDirection(int index, point_set_t *s, point_t* pt, float* &v);
+
+// the MRR LP of one point against the first points of a set growing at its end, kept across calls
+typedef struct worst_direction_lp
+{
+	incremental_lp_t	lp;
+	int					K;		// points of the set whose rows are in lp, 0 before the first call
+
+}	worst_direction_lp_t;
+
+// worstDirection(index, s, pt, v) on the LP of pt kept in wlp: only the rows of the points added to s since
+// the last call are added, and the LP is re-solved from its last optimal basis
+double worstDirection(worst_direction_lp_t& wlp, int index, point_set_t *s, point_t* pt, double* v);
+
 double determinant(int n, double** a);
 
 
 /*
  * Compute the MRR of a given set of points
  */
+// minimum number of points per thread in evaluateLP
+#define EVALUATE_MIN_SHARD 64
+
+// number of threads solving the LPs of evaluateLP (EVALUATE_THREADS, else the number of cores)
+int evaluate_threads();
+
 // original MRR evaluation, consider worse case MRR
 double evaluateLP(point_set_t *p, point_set_t* S, int VERBOSE);
 // use random sampling
@@ -38,5 +58,23 @@ double evaluateLP(point_set_t *p, point_set_t* S, int VERBOSE, int d, std::set<i
 // use the ground truth utility vector u
 double evaluateLP(point_set_t *p, point_set_t* S, int VERBOSE, point_t* u);
 
+// utility vectors per block of the Monte-Carlo kernel, and points per chunk streamed through it
+#define MC_BLOCK 64
+#define MC_CHUNK 4096
+
+// regret ratios of S over random utility vectors
+typedef struct regret_estimate
+{
+	double	max;		// largest regret ratio of the samples
+	double	mean;		// average regret ratio of the samples
+	double	mean_error;	// half-width of the 95% confidence interval of the mean
+	double	tail;		// with 95% confidence, at most this fraction of utility vectors has a regret ratio above max
+	int		samples;
+
+}	regret_estimate_t;
+
+// Monte-Carlo MRR estimate over M utility vectors drawn uniformly from the simplex on the dimensions dims (all if empty)
+regret_estimate_t evaluateMC(point_set_t *p, point_set_t* S, int VERBOSE, int M = 10000, std::set<int> dims = std::set<int>());
+
 
 #endif
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include "maxUtility.h"
 #include <iostream>
 #include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 // get the index of the "current best" point
 // P: the input car set
@@ -207,24 +210,13 @@ vector<int> generate_S(point_set_t* P, vector<int>& C_idx, int s, int current_be
 }
 
 
-// generate the options for user selection and update the extreme vecotrs based on the user feedback
-// wPrt: record user's feedback
-// P_car: the set of candidate cars with seqential ids
-// skyline_proc_P: the skyline set of normalized cars
-// C_idx: the indexes of the current candidate favorite car in skyline_proc_P
-// ext_vec: the set of extreme vecotr
-// current_best_idx: the current best car
-// last_best: the best car in previous interaction
-// frame: the frame for obtaining the set of neibouring vertices of the current best vertiex (used only if cmp_option = SIMPLEX)
-// cmp_option: the car selection mode, which must be either SIMPLEX or RANDOM
-void update_ext_vec(point_set_t* P_raw, std::set<int> set_final_dimensions, point_set_t* P, vector<int>& C_idx, point_t* u, int s, vector<point_t*>& ext_vec, int& current_best_idx, int& last_best, vector<int>& frame, int cmp_option, bool &keep_answer)
+// print the options of a question of max_utility
+// P_raw: the raw car set, used for printing
+// set_final_dimensions: the dimensions shown to the user
+// ids: the ids of the options
+void print_options(point_set_t* P_raw, std::set<int> set_final_dimensions, const vector<int>& ids)
 {
-	// generate s cars for selection in a round
-	vector<int> S = generate_S(P, C_idx, s, current_best_idx, last_best, frame, cmp_option);
-
 	int m = set_final_dimensions.size();
-    // double max = 0;
-    // int max_i = 0;
 
     printf("\nPlease choose the option you favor more:\n");
     printf("dimensions: \n");
@@ -234,16 +226,20 @@ void update_ext_vec(point_set_t* P_raw, std::set<int> set_final_dimensions, poin
     printf("|\n");
     printf("-----------------------------------------------------------------\n");
 
-    for (int j = 0; j < S.size(); ++j) {
+    for (int j = 0; j < (int)ids.size(); ++j) {
         for (int k = 0; k < m; ++k) {
-            printf("|%10.3f", P_raw->points[P->points[C_idx[S[j]]]->id]->coord[*next(set_final_dimensions.begin(), k)]);
+            printf("|%10.3f", raw_coord(P_raw, ids[j], *next(set_final_dimensions.begin(), k)));
         }
         printf("|\n");
     }
     printf("-----------------------------------------------------------------\n");
     printf("Your choice (0 for not interested): ");
     fflush(stdout);  // Force output to be sent immediately
+}
 
+// read the user's choice as typed: 0 for not interested, 1 or 2 for an option, -99 to stop
+int scan_answer()
+{
 	int max_i = -1;
     
     // // Use web-compatible input method
@@ -260,14 +256,61 @@ void update_ext_vec(point_set_t* P_raw, std::set<int> set_final_dimensions, poin
     //     max_i = 0;
     // }
 	while (max_i != 0 && max_i != 1 && max_i != 2 && max_i != -99){
-        scanf("%d", &max_i);
-    }
-	if (max_i == -99) {
-		keep_answer = false;
+		int rc = scanf("%d", &max_i);
+		// no answer can come from a closed input (e.g. the web client went away), stop the run
+		if (rc == EOF)
+			exit(1);
+		// skip the rest of a line that is not a number and ask again
+		if (rc != 1)
+		{
+			int ch;
+			while ((ch = getchar()) != '\n' && ch != EOF) {}
+			max_i = -1;
+		}
+	}
+	return max_i;
+}
+
+// show the options of a question, or post them to the session max_utility runs in
+// P_raw: the raw car set, used for printing
+// set_final_dimensions: the dimensions shown to the user
+// P: the normalized car set
+// C_idx: the indexes of the current candidate favorite car in P
+// S: the options, as indexes in C_idx
+void show_options(point_set_t* P_raw, std::set<int> set_final_dimensions, point_set_t* P, vector<int>& C_idx, vector<int>& S)
+{
+	vector<int> ids;
+	for (int j = 0; j < (int)S.size(); ++j)
+		ids.push_back(P->points[C_idx[S[j]]]->id);
+
+	if (current_session() == NULL)
+	{
+		print_options(P_raw, set_final_dimensions, ids);
 		return;
 	}
+
+	vector<double> coords;
+	for (int j = 0; j < (int)S.size(); ++j)
+		for (int k = 0; k < P->points[0]->dim; ++k)
+			coords.push_back(P->points[C_idx[S[j]]]->coord[k]);
+	session_post(3, set_final_dimensions, ids, coords);
+}
+
+// read the user's choice, from stdin or from the session max_utility runs in:
+// the index of the chosen option in S, or -1 if the user stops the interaction
+int read_answer()
+{
+	int max_i = current_session() != NULL ? session_wait() : scan_answer();
+
+	if (max_i == -99)
+		return -1;
 	if (max_i != 0) max_i = max_i-1;
+	return max_i;
+}
 
+// update the extreme vecotrs and the candidate set with the user's choice max_i among the options S
+void apply_answer(point_set_t* P, vector<int>& C_idx, vector<int>& S, int max_i, vector<point_t*>& ext_vec, int& current_best_idx, int& last_best)
+{
 	// get the better car among those from the user
 	last_best = current_best_idx;
 	current_best_idx = C_idx[S[max_i]];
@@ -275,6 +318,7 @@ void update_ext_vec(point_set_t* P_raw, std::set<int> set_final_dimensions, poin
 		
 
 	// for each non-favorite car, create a new extreme vecotr
+	int old_size = ext_vec.size();
 	for(int i = 0; i < S.size(); i++)
 	{
 		if(max_i == i)
@@ -289,6 +333,14 @@ void update_ext_vec(point_set_t* P_raw, std::set<int> set_final_dimensions, poin
 		ext_vec.push_back(new_ext_vec);
 	}
 
+	// an answer contradicting the earlier ones would leave no utility vector in R, keep R as it was
+	if((int)ext_vec.size() > old_size && is_empty_range(ext_vec))
+	{
+		for(int i = old_size; i < (int)ext_vec.size(); i++)
+			release_point(ext_vec[i]);
+		ext_vec.resize(old_size);
+	}
+
 	// directly remove the non-favorite car from the candidate set
 	vector<int> newC_idx;
 	for(int i = 0; i < C_idx.size(); i++)
@@ -299,6 +351,157 @@ void update_ext_vec(point_set_t* P_raw, std::set<int> set_final_dimensions, poin
 	C_idx = newC_idx;
 }
 
+// generate the options for user selection and update the extreme vecotrs based on the user feedback
+// wPrt: record user's feedback
+// P_car: the set of candidate cars with seqential ids
+// skyline_proc_P: the skyline set of normalized cars
+// C_idx: the indexes of the current candidate favorite car in skyline_proc_P
+// ext_vec: the set of extreme vecotr
+// current_best_idx: the current best car
+// last_best: the best car in previous interaction
+// frame: the frame for obtaining the set of neibouring vertices of the current best vertiex (used only if cmp_option = SIMPLEX)
+// cmp_option: the car selection mode, which must be either SIMPLEX or RANDOM
+void update_ext_vec(point_set_t* P_raw, std::set<int> set_final_dimensions, point_set_t* P, vector<int>& C_idx, point_t* u, int s, vector<point_t*>& ext_vec, int& current_best_idx, int& last_best, vector<int>& frame, int cmp_option, bool &keep_answer)
+{
+	// generate s cars for selection in a round
+	vector<int> S = generate_S(P, C_idx, s, current_best_idx, last_best, frame, cmp_option);
+
+	show_options(P_raw, set_final_dimensions, P, C_idx, S);
+
+	int max_i = read_answer();
+	if (max_i == -1) {
+		keep_answer = false;
+		return;
+	}
+
+	apply_answer(P, C_idx, S, max_i, ext_vec, current_best_idx, last_best);
+}
+
+// Number of threads computing the answers to a question ahead of time: the SPECULATE_THREADS environment variable, 0 (no speculation) if unset.
+// Each branch prunes its own candidate set with sql_pruning whatever the prune_option of max_utility: the persistent R-tree
+// follows a single candidate set, and rtree_pruning on a tree built for the branch is slower than sql_pruning on the same candidates.
+int speculate_threads()
+{
+	const char* env = getenv("SPECULATE_THREADS");
+	if (env != NULL && atoi(env) > 0)
+		return atoi(env);
+	return 0;
+}
+
+// the state of the interaction after one possible answer, computed while the user is thinking
+typedef struct speculation
+{
+	vector<int>			C_idx;
+	vector<point_t*>	ext_vec;	// a copy of its own, since the pruning replaces the extreme vectors
+	int					current_best_idx;
+	int					last_best;
+	vector<int>			frame;
+	double				rr;
+	vector<int>			S;			// the next question, empty if it is left to the caller
+	bool				done;
+}	speculation_t;
+
+/*
+ * One branch per option of the question S. Branch j runs on thread j % threads; a branch is skipped,
+ * or stops before generating its question, once the user has chosen another option.
+ */
+typedef struct speculation_round
+{
+	vector<int>				S;
+	vector<speculation_t>	branch;
+	vector<std::thread>		threads;
+	std::mutex				m;
+	std::condition_variable	done;
+	int						answer;		// the chosen option, -1 while the user is thinking, -2 if the user stopped
+}	speculation_round_t;
+
+static bool speculation_wanted(speculation_round_t* round, int j)
+{
+	std::lock_guard<std::mutex> lock(round->m);
+	return round->answer == -1 || round->answer == j;
+}
+
+static void run_speculation(speculation_round_t* round, int t, int threads, point_set_t* P, int s, double epsilon, bool more_rounds, int cmp_option, int stop_option, int dom_option)
+{
+	for(int j = t; j < (int)round->branch.size(); j += threads)
+	{
+		speculation_t& b = round->branch[j];
+		if(speculation_wanted(round, j))
+		{
+			apply_answer(P, b.C_idx, round->S, j, b.ext_vec, b.current_best_idx, b.last_best);
+
+			if(b.C_idx.size() > 1)
+				sql_pruning(P, b.C_idx, b.ext_vec, b.rr, stop_option, dom_option);
+
+			// random options are drawn by the caller, which keeps the sequence of rand() of a run without speculation
+			if(cmp_option != RANDOM && more_rounds && b.C_idx.size() > 1 && (b.rr > epsilon && !isZero(b.rr - epsilon)) && speculation_wanted(round, j))
+			{
+				sort(b.C_idx.begin(), b.C_idx.end());
+				b.S = generate_S(P, b.C_idx, s, b.current_best_idx, b.last_best, b.frame, cmp_option);
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(round->m);
+		b.done = true;
+		round->done.notify_all();
+	}
+	glp_free_env(); // the GLPK environment of this thread, used if an LP fell back to GLPK
+}
+
+// start computing the state after each option of the question S on threads threads
+static speculation_round_t* start_speculation(point_set_t* P, vector<int>& C_idx, vector<int>& S, int s, vector<point_t*>& ext_vec, int current_best_idx, int last_best, vector<int>& frame, double rr, double epsilon, bool more_rounds, int cmp_option, int stop_option, int dom_option, int threads)
+{
+	speculation_round_t* round = new speculation_round_t;
+	round->S = S;
+	round->answer = -1;
+	round->branch.resize(S.size());
+	for(int j = 0; j < (int)S.size(); j++)
+	{
+		speculation_t& b = round->branch[j];
+		b.C_idx = C_idx;
+		for(int i = 0; i < (int)ext_vec.size(); i++)
+			b.ext_vec.push_back(copy(ext_vec[i]));
+		b.current_best_idx = current_best_idx;
+		b.last_best = last_best;
+		b.frame = frame;
+		b.rr = rr;
+		b.done = false;
+	}
+
+	if(threads > (int)S.size())
+		threads = S.size();
+	for(int t = 0; t < threads; t++)
+		round->threads.push_back(std::thread(run_speculation, round, t, threads, P, s, epsilon, more_rounds, cmp_option, stop_option, dom_option));
+	return round;
+}
+
+// record the user's choice max_i (-1 if the user stopped) and wait for the branch of that choice
+static speculation_t* await_speculation(speculation_round_t* round, int max_i)
+{
+	std::unique_lock<std::mutex> lock(round->m);
+	round->answer = max_i >= 0 ? max_i : -2;
+	if(max_i < 0)
+		return NULL;
+	round->done.wait(lock, [&]{ return round->branch[max_i].done; });
+	return &round->branch[max_i];
+}
+
+// wait for the discarded branches and release them
+static void release_speculation(speculation_round_t* round)
+{
+	{
+		std::lock_guard<std::mutex> lock(round->m);
+		if(round->answer == -1)
+			round->answer = -2;
+	}
+	for(int t = 0; t < (int)round->threads.size(); t++)
+		round->threads[t].join();
+	for(int j = 0; j < (int)round->branch.size(); j++)
+		for(int i = 0; i < (int)round->branch[j].ext_vec.size(); i++)
+			release_point(round->branch[j].ext_vec[i]);
+	delete round;
+}
+
 // the main interactive algorithm
 // P: the input dataset (assumed skyline)
 // u: the unkonwn utility vector
@@ -356,14 +559,55 @@ point_t* max_utility(point_set_t* P_raw, std::set<int> set_final_dimensions, poi
 	Qcount = 0;
 	double rr = 1;
 
+	// with speculation, the candidate set and the next question after each option are computed while the user is thinking
+	int spec_threads = speculate_threads();
+	speculation_round_t* round = NULL;
+	vector<int> S; // the next question, if it was computed ahead
+
+	// the R-tree over the candidate set is built once; each round only deletes the pruned points from it
+	candidate_rtree_t* tree = NULL;
+	if(prune_option != SQL && spec_threads == 0)
+		tree = alloc_candidate_rtree(P, C_idx);
+
 	// interactively reduce the candidate set and shrink the candidate utility range
 	while (C_idx.size()> 1 && (rr > epsilon  && !isZero(rr - epsilon)) && Qcount <  maxRound && keep_answer)  // while none of the stopping conditiong is true
 	{
 		Qcount++;
 		sort(C_idx.begin(), C_idx.end()); // prevent select two different points after different skyline algorithms
 		
-		// generate the options for user selection and update the extreme vecotrs based on the user feedback
-		update_ext_vec(P_raw, set_final_dimensions, P, C_idx, u, s, ext_vec, current_best_idx, last_best, frame, cmp_option, keep_answer);
+		if(spec_threads > 0)
+		{
+			if(S.empty())
+				S = generate_S(P, C_idx, s, current_best_idx, last_best, frame, cmp_option);
+			show_options(P_raw, set_final_dimensions, P, C_idx, S);
+
+			speculation_round_t* next = start_speculation(P, C_idx, S, s, ext_vec, current_best_idx, last_best, frame, rr, epsilon, Qcount < maxRound, cmp_option, stop_option, dom_option, spec_threads);
+			if(round != NULL)
+				release_speculation(round);
+			round = next;
+
+			// commit the branch of the user's choice; the old state goes to the branch and is released with it
+			speculation_t* b = await_speculation(round, read_answer());
+			if(b != NULL)
+			{
+				C_idx.swap(b->C_idx);
+				ext_vec.swap(b->ext_vec);
+				frame.swap(b->frame);
+				S.swap(b->S);
+				b->S.clear();
+				current_best_idx = b->current_best_idx;
+				last_best = b->last_best;
+				rr = b->rr;
+				continue;
+			}
+			keep_answer = false;
+			break;
+		}
+		else
+		{
+			// generate the options for user selection and update the extreme vecotrs based on the user feedback
+			update_ext_vec(P_raw, set_final_dimensions, P, C_idx, u, s, ext_vec, current_best_idx, last_best, frame, cmp_option, keep_answer);
+		}
 
 		if(C_idx.size()==1 ) // || global_best_idx == current_best_idx
 			break;
@@ -372,8 +616,12 @@ point_t* max_utility(point_set_t* P_raw, std::set<int> set_final_dimensions, poi
 		if(prune_option == SQL)
 			sql_pruning(P, C_idx, ext_vec, rr, stop_option, dom_option);
 		else
-			rtree_pruning(P, C_idx, ext_vec, rr, stop_option, dom_option);
+			rtree_pruning(P, C_idx, ext_vec, rr, stop_option, dom_option, tree);
 	}
+	if(round != NULL)
+		release_speculation(round);
+	if(tree != NULL)
+		release_candidate_rtree(tree);
 
 	// get the final result 
 	point_t* result = P->points[get_current_best_pt(P, C_idx, ext_vec)];
@@ -12,6 +12,7 @@
 #include "rtree.h"
 #include "lp.h"
 #include "pruning.h"
+#include "session.h"
 #include <queue>
 
 #include "../util.h"
@@ -31,12 +32,30 @@ struct question_mapping {
 // get the index of the "current best" point
 int get_current_best_pt(point_set_t* P, vector<int>& C_idx, vector<point_t*>& ext_vec);
 
+// print the options of a question of max_utility
+void print_options(point_set_t* P_raw, std::set<int> set_final_dimensions, const vector<int>& ids);
+
+// read the user's choice as typed: 0 for not interested, 1 or 2 for an option, -99 to stop
+int scan_answer();
+
+// show the options of a question, or post them to the session max_utility runs in
+void show_options(point_set_t* P_raw, std::set<int> set_final_dimensions, point_set_t* P, vector<int>& C_idx, vector<int>& S);
+
+// read the user's choice, from stdin or from the session max_utility runs in: the index of the chosen option, or -1 if the user stops
+int read_answer();
+
+// update the extreme vecotrs and the candidate set with the user's choice max_i among the options S
+void apply_answer(point_set_t* P, vector<int>& C_idx, vector<int>& S, int max_i, vector<point_t*>& ext_vec, int& current_best_idx, int& last_best);
+
 // generate s cars for selection in a round
 void update_ext_vec(point_set_t* P_raw, std::set<int> set_final_dimensions, point_set_t* P, vector<int>& C_idx, point_t* u, int s, vector<point_t*>& ext_vec, int& current_best_idx, int& last_best, vector<int>& frame, int cmp_option, bool &keep_answer);
 
 // generate the options for user selection and update the extreme vecotrs based on the user feedback
 vector<int> generate_S(point_set_t* P, vector<int>& C_idx, int s, int current_best_idx, int& last_best, vector<int>& frame, int cmp_option);
 
+// Number of threads computing the answers to a question ahead of time: the SPECULATE_THREADS environment variable, 0 (no speculation) if unset
+int speculate_threads();
+
 // the main interactive algorithm
 point_t* max_utility(point_set_t* P_raw, std::set<int> set_final_dimensions, point_set_t* P, point_t* u, int s,  double epsilon, int maxRound, double &Qcount, double &Csize,  int cmp_option, int stop_option, int prune_option, int dom_option);
 
@@ -57,7 +57,7 @@ void   *qh_malloc(size_t size);
     see mem.h for definition
 */
 
-qhmemT qhmem= {0,0,0,0,0,0,0,0,0,0,0,
+qh_THREADLOCAL qhmemT qhmem= {0,0,0,0,0,0,0,0,0,0,0,
                0,0,0,0,0,0,0,0,0,0,0,
                0,0,0,0,0,0,0};     /* remove "= {0}" if this causes a compiler error */
 
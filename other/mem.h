@@ -102,8 +102,16 @@ typedef long ptr_intT;
    If you need separate address spaces, you can swap the
    contents of qhmem.
 */
+#ifndef qh_THREADLOCAL  /* see user.h */
+#if defined(_MSC_VER)
+#define qh_THREADLOCAL __declspec(thread)
+#else
+#define qh_THREADLOCAL __thread
+#endif
+#endif
+
 typedef struct qhmemT qhmemT;
-extern qhmemT qhmem;
+extern qh_THREADLOCAL qhmemT qhmem;
 
 #ifndef DEFsetT
 #define DEFsetT 1
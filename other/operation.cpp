@@ -1,16 +1,20 @@
 #include "operation.h"
 #include "data_utility.h"
+#include "read_write.h"
+#include "dominance.h"
 #include <stdlib.h>
 #include <chrono>
 #include <random>
 #include <cmath>
 #include <algorithm>
 #include <iostream>
+#include <thread>
 using namespace std;
 
 // Common functions from both files:
 point_set_t* remove_outliers(point_set_t* &point_set);
 void linear_normalize(point_set_t* &point_set);
+double raw_coord(point_set_t* point_set, int id, int k);
 void reduce_to_unit(point_set_t* &point_set);
 vector<vector<double> > generate_JL(int k, int d, int matrix_type);
 vector<vector<double> > generate_JL(int k, int d, point_set_t* &P);
@@ -33,9 +37,14 @@ vector<double> gaussNtimesD(vector<vector<double> > A);
 point_t* projectPointsOntoAffineSpace(point_set_t* space, point_t* p);
 Vvi build_input(int t, int dim);
 void cart_product(Vvi& rvvi, Vi& rvi, Vvi::const_iterator me, Vvi::const_iterator end);
+point_set_t* load_points(char* input);
 point_set_t* read_points(char* input);
 int dominates(point_t* p1, point_t* p2);
+int dominates(const COORD_TYPE* p1, const COORD_TYPE* p2, int dim);
 point_set_t* skyline_point(point_set_t *p);
+point_set_t* skyline_point(point_set_t *p, int num_threads, int algo);
+int skyline_threads();
+int skyline_algorithm();
 void insertOrth(double* &points, int &count, point_t* v);
 
 // Unique functions from interactive/operation.cpp:
@@ -92,12 +101,12 @@ point_set_t* remove_outliers(point_set_t* &point_set) {
     }
 
     // Create new point set without outliers
-    point_set_t* new_point_set = alloc_point_set(select_n_count);
+    point_set_t* new_point_set = alloc_point_set(select_n_count, select_dim_count);
     int index_n = 0;
     for (int i = 0; i < n; ++i) {
         if (select_n_index[i]) {
             int index_dim = 0;
-            point_t* new_point = alloc_point(select_dim_count);
+            point_t* new_point = new_point_set->points[index_n];
             new_point->id = index_n;
             for (int j = 0; j < dim; ++j) {
                 if (select_dim_index[j]) {
@@ -105,18 +114,38 @@ point_set_t* remove_outliers(point_set_t* &point_set) {
                     index_dim++;
                 }
             }
-            new_point_set->points[index_n] = new_point;
             index_n++;
         }
     }
+    index_point_store(new_point_set->store);
     release_point_set(point_set, false);
     return new_point_set;
 }
 
+// Raw value of dimension k of the point with the given id, undoing linear_normalize if it was applied
+double raw_coord(point_set_t* point_set, int id, int k) {
+    point_store_t* store = point_set->store;
+    int row = point_store_row(store, id);
+    point_t* p = row >= 0 ? &store->rows[row] : point_set->points[id];
+
+    if (store == NULL || store->min == NULL)
+        return p->coord[k];
+    return store->min[k] + p->coord[k] * (store->max[k] - store->min[k]);
+}
+
 // Linear normalization of point set
+// If the point set is backed by a store, the raw range of each dimension is kept there for raw_coord, and a store
+// that already has its ranges (e.g. a mapped binary dataset) is left as it is.
 void linear_normalize(point_set_t* &point_set) {
     int dim = point_set->points[0]->dim;
     int n = point_set->numberOfPoints;
+    point_store_t* store = point_set->store;
+    if (store != NULL && store->min != NULL)
+        return;
+    if (store != NULL) {
+        store->min = (COORD_TYPE*)malloc(dim * sizeof(COORD_TYPE));
+        store->max = (COORD_TYPE*)malloc(dim * sizeof(COORD_TYPE));
+    }
     
     for (int i = 0; i < dim; ++i) {
         double min = point_set->points[0]->coord[i];
@@ -127,6 +156,10 @@ void linear_normalize(point_set_t* &point_set) {
             min = (point_set->points[j]->coord[i] < min) ? point_set->points[j]->coord[i] : min;
             max = (point_set->points[j]->coord[i] > max) ? point_set->points[j]->coord[i] : max;
         }
+        if (store != NULL) {
+            store->min[i] = min;
+            store->max[i] = max;
+        }
         
         // Normalize dimension i
         for (int j = 0; j < n; ++j) {
@@ -442,73 +475,249 @@ void cart_product(Vvi& rvvi, Vi& rvi, Vvi::const_iterator me, Vvi::const_iterato
     }
 }
 
-// Read points from file
-point_set_t* read_points(char* input) {
-    FILE* c_fp;
-    char filename[MAX_FILENAME_LENG];
-    sprintf(filename, "%s", input);
+// Read points from file (either the text format or the binary dataset format); NULL if the file is missing or malformed
+point_set_t* load_points(char* input) {
+    if (is_binary_dataset(input))
+        return load_points_binary(input);
 
-    if ((c_fp = fopen(filename, "r")) == NULL) {
-        fprintf(stderr, "Cannot open the data file %s.\n", filename);
-        exit(0);
+    FILE* c_fp;
+    if ((c_fp = fopen(input, "r")) == NULL) {
+        fprintf(stderr, "Cannot open the data file %s.\n", input);
+        return NULL;
     }
 
+    // each number takes at least two bytes with its separator, which bounds the points a header can claim
+    fseek(c_fp, 0, SEEK_END);
+    long size = ftell(c_fp);
+    rewind(c_fp);
+
     int number_of_points, dim;
-    fscanf(c_fp, "%i%i", &number_of_points, &dim);
+    if (fscanf(c_fp, "%i%i", &number_of_points, &dim) != 2 || number_of_points <= 0 || dim <= 0 ||
+        (long long)number_of_points * dim > size / 2 + 1) {
+        fprintf(stderr, "Invalid data file %s.\n", input);
+        fclose(c_fp);
+        return NULL;
+    }
 
-    point_set_t* point_set = alloc_point_set(number_of_points);
+    point_set_t* point_set = alloc_point_set(number_of_points, dim);
 
+    // a value that does not parse ends the reading, and it and the rest stay 0 as allocated: car.txt has one
+    // (1,045.54129) and every result so far was computed that way
     for (int i = 0; i < number_of_points; i++) {
-        point_t* p = alloc_point(dim, i);
+        point_t* p = point_set->points[i];
+        p->id = i;
         for (int j = 0; j < dim; j++) {
             fscanf(c_fp, "%lf", &p->coord[j]);
         }
-        point_set->points[i] = p;
     }
+    index_point_store(point_set->store);
 
     fclose(c_fp);
     return point_set;
 }
 
+// Read points from file, exiting if the file is missing or malformed
+point_set_t* read_points(char* input) {
+    point_set_t* point_set = load_points(input);
+    if (point_set == NULL)
+        exit(0);
+    return point_set;
+}
+
 // Check dominance for skyline computation
 int dominates(point_t* p1, point_t* p2) {
-    for (int i = 0; i < p1->dim; ++i)
-        if (p1->coord[i] < p2->coord[i])
-            return 0;
-    return 1;
+    return dominates(p1->coord, p2->coord, p1->dim);
 }
 
-// Compute skyline points
-point_set_t* skyline_point(point_set_t* p) {
-    int* sl = new int[p->numberOfPoints];
-    int index = 0;
+// Check dominance on raw coordinate rows
+int dominates(const COORD_TYPE* p1, const COORD_TYPE* p2, int dim) {
+    return dominates_rows(p1, p2, dim);
+}
 
-    for (int i = 0; i < p->numberOfPoints; ++i) {
-        int dominated = 0;
-        point_t* pt = p->points[i];
+// Check whether a window point sl[from..] dominates pt, DOMINANCE_BLOCK window points at a time
+static int window_dominates(const COORD_TYPE* pt, const COORD_TYPE** rows, const vector<int>& sl, int from, int dim) {
+    for (int j = from; j < (int)sl.size(); j += DOMINANCE_BLOCK)
+        if (dominated_by_mask(pt, rows, &sl[j], min((int)sl.size() - j, DOMINANCE_BLOCK), dim))
+            return 1;
+    return 0;
+}
 
-        // Check if pt is dominated by current skyline
-        for (int j = 0; j < index && !dominated; ++j)
-            if (dominates(p->points[sl[j]], pt))
-                dominated = 1;
+// Remove the window points sl[from..] dominated by pt, DOMINANCE_BLOCK window points at a time
+static void window_evict(const COORD_TYPE* pt, const COORD_TYPE** rows, vector<int>& sl, int from, int dim) {
+    int index = from;
+    for (int j = from; j < (int)sl.size(); j += DOMINANCE_BLOCK) {
+        int count = min((int)sl.size() - j, DOMINANCE_BLOCK);
+        uint64_t mask = dominates_mask(pt, rows, &sl[j], count, dim);
+        for (int b = 0; b < count; ++b)
+            if (!(mask >> b & 1))
+                sl[index++] = sl[j + b];
+    }
+    sl.resize(index);
+}
 
-        if (!dominated) {
+// Block-nested-loop skyline of the rows [begin, end), appending the indices of the skyline rows to sl in index order
+static void skyline_bnl(const COORD_TYPE** rows, int dim, int begin, int end, vector<int>& sl) {
+    for (int i = begin; i < end; ++i) {
+        const COORD_TYPE* pt = rows[i];
+
+        // Check if pt is dominated by current skyline
+        if (!window_dominates(pt, rows, sl, 0, dim)) {
             // Remove dominated points from current skyline
-            int m = index;
-            index = 0;
-            for (int j = 0; j < m; ++j)
-                if (!dominates(pt, p->points[sl[j]]))
-                    sl[index++] = sl[j];
+            window_evict(pt, rows, sl, 0, dim);
+
+            sl.push_back(i);
+        }
+    }
+}
+
+// Sort-filter skyline of the rows [begin, end), appending the indices of the skyline rows to sl in index order
+// The rows are visited by decreasing score (the coordinate sum), which no dominated point can exceed, so a window
+// point can only be dominated by a later point of the same score and the window needs no other evictions.
+// The scan stops early once a window point is larger in every dimension than all the remaining points.
+static void skyline_sfs(const COORD_TYPE** rows, const double* score, int dim, int begin, int end, vector<int>& sl) {
+    int m = end - begin;
+    vector<int> order(m);
+    for (int i = begin; i < end; ++i)
+        order[i - begin] = i;
+    stable_sort(order.begin(), order.end(), [score](int a, int b) { return score[a] > score[b]; });
+
+    // suffix_max[t]: the largest coordinate among the points order[t..m-1]
+    vector<double> suffix_max(m + 1, -DBL_MAX);
+    for (int t = m - 1; t >= 0; --t) {
+        const COORD_TYPE* pt = rows[order[t]];
+        suffix_max[t] = suffix_max[t + 1];
+        for (int k = 0; k < dim; ++k)
+            suffix_max[t] = max(suffix_max[t], pt[k]);
+    }
+    double stop = -DBL_MAX; // the largest minimum coordinate of a window point
+
+    int tie = 0; // the window points from tie on have the score of the current point
+    for (int t = 0; t < m && stop <= suffix_max[t]; ++t) {
+        int i = order[t];
+        const COORD_TYPE* pt = rows[i];
+        if (tie < (int)sl.size() && score[sl[tie]] != score[i])
+            tie = sl.size();
+
+        if (!window_dominates(pt, rows, sl, 0, dim)) {
+            window_evict(pt, rows, sl, tie, dim);
+
+            sl.push_back(i);
+            stop = max(stop, *min_element(pt, pt + dim));
+        }
+    }
+    sort(sl.begin(), sl.end());
+}
+
+// Number of threads used by skyline_point: the SKYLINE_THREADS environment variable if set, else the number of cores
+int skyline_threads() {
+    const char* env = getenv("SKYLINE_THREADS");
+    if (env != NULL && atoi(env) > 0)
+        return atoi(env);
+
+    int cores = thread::hardware_concurrency();
+    return cores > 0 ? cores : 1;
+}
 
-            sl[index++] = i;
+// Skyline algorithm used by skyline_point: SKYLINE_ALGO=sfs selects SFS, otherwise BNL is used
+int skyline_algorithm() {
+    const char* env = getenv("SKYLINE_ALGO");
+    if (env != NULL && strcmp(env, "sfs") == 0)
+        return SKYLINE_SFS;
+    return SKYLINE_BNL;
+}
+
+// Compute skyline points
+point_set_t* skyline_point(point_set_t* p) {
+    return skyline_point(p, skyline_threads(), skyline_algorithm());
+}
+
+// Compute skyline points with num_threads threads using algo (SKYLINE_BNL or SKYLINE_SFS)
+// The input is split into one block per thread and each thread computes the skyline of its block. A local skyline point
+// is then kept unless a local skyline point of another block dominates it; of equal points only the first is kept, as in
+// the sequential scan, so the result is the same skyline in the same order.
+point_set_t* skyline_point(point_set_t* p, int num_threads, int algo) {
+    int n = p->numberOfPoints;
+    if (n == 0)
+        return alloc_point_set(0);
+    int dim = p->points[0]->dim;
+
+    // keep the coordinate rows in one array so that the window scans do not chase point_t pointers
+    const COORD_TYPE** rows = new const COORD_TYPE*[n];
+    for (int i = 0; i < n; ++i)
+        rows[i] = p->points[i]->coord;
+
+    // the coordinate sum, a point can only be dominated by points with a sum at least as large
+    double* score = new double[n];
+    for (int i = 0; i < n; ++i) {
+        score[i] = 0;
+        for (int k = 0; k < dim; ++k)
+            score[i] += rows[i][k];
+    }
+
+    // small inputs are not worth the threads
+    int blocks = min(num_threads, n / SKYLINE_MIN_BLOCK);
+    if (blocks < 1)
+        blocks = 1;
+
+    vector<vector<int> > local(blocks);
+    auto block_skyline = [&](int b) {
+        int begin = (long long)n * b / blocks, end = (long long)n * (b + 1) / blocks;
+        if (algo == SKYLINE_BNL)
+            skyline_bnl(rows, dim, begin, end, local[b]);
+        else
+            skyline_sfs(rows, score, dim, begin, end, local[b]);
+    };
+
+    if (blocks == 1)
+        block_skyline(0);
+    else {
+        vector<thread> workers;
+        for (int b = 0; b < blocks; ++b)
+            workers.push_back(thread(block_skyline, b));
+        for (int b = 0; b < blocks; ++b)
+            workers[b].join();
+
+        // cross-block filtering of the local skylines
+        vector<vector<int> > kept(blocks);
+        for (int b = 0; b < blocks; ++b) {
+            workers[b] = thread([&, b]() {
+                for (int i : local[b]) {
+                    int dominated = 0;
+                    for (int c = 0; c < blocks && !dominated; ++c) {
+                        if (c == b)
+                            continue;
+                        for (int j = 0; j < (int)local[c].size() && !dominated; j += DOMINANCE_BLOCK) {
+                            int count = min((int)local[c].size() - j, DOMINANCE_BLOCK);
+                            uint64_t mask = dominated_by_mask(rows[i], rows, &local[c][j], count, dim);
+                            for (int b = 0; b < count && !dominated; ++b) {
+                                int q = local[c][j + b];
+                                if ((mask >> b & 1) && score[q] >= score[i] && (q < i || !dominates(rows[i], rows[q], dim)))
+                                    dominated = 1;
+                            }
+                        }
+                    }
+                    if (!dominated)
+                        kept[b].push_back(i);
+                }
+            });
         }
+        for (int b = 0; b < blocks; ++b)
+            workers[b].join();
+        local.swap(kept);
     }
 
+    int index = 0;
+    for (int b = 0; b < blocks; ++b)
+        index += local[b].size();
+
     point_set_t* skyline = alloc_point_set(index);
-    for (int i = 0; i < index; i++)
-        skyline->points[i] = p->points[sl[i]];
+    index = 0;
+    for (int b = 0; b < blocks; ++b)
+        for (int i : local[b])
+            skyline->points[index++] = p->points[i];
 
-    delete[] sl;
+    delete[] rows;
+    delete[] score;
     return skyline;
 }
 
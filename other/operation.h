@@ -14,10 +14,16 @@ typedef vector<Vi> Vvi;
 // Constants
 #define MAX_FILENAME_LENG 256
 #define EQN_EPS 1e-9
+#define SKYLINE_MIN_BLOCK 1024 // minimum number of points per thread in skyline_point
+
+// skyline algorithms
+#define SKYLINE_BNL 0 // block-nested-loop
+#define SKYLINE_SFS 1 // sort-filter-skyline
 
 // Common functions
 point_set_t* remove_outliers(point_set_t* &point_set);
 void linear_normalize(point_set_t* &point_set);
+double raw_coord(point_set_t* point_set, int id, int k);
 void reduce_to_unit(point_set_t* &point_set);
 int isZero(double x);
 DIST_TYPE calc_len(point_t* point_v);
@@ -40,9 +46,14 @@ vector<double> gaussNtimesD(vector<vector<double>> A);
 point_t* projectPointsOntoAffineSpace(point_set_t* space, point_t* p);
 Vvi build_input(int t, int dim);
 void cart_product(Vvi& rvvi, Vi& rvi, Vvi::const_iterator me, Vvi::const_iterator end);
+point_set_t* load_points(char* input);
 point_set_t* read_points(char* input);
 int dominates(point_t* p1, point_t* p2);
+int dominates(const COORD_TYPE* p1, const COORD_TYPE* p2, int dim);
 point_set_t* skyline_point(point_set_t *p);
+point_set_t* skyline_point(point_set_t *p, int num_threads, int algo);
+int skyline_threads();
+int skyline_algorithm();
 void insertOrth(double* &points, int &count, point_t* v);
 
 // Functions from interactive/operation.cpp
@@ -1,6 +1,5 @@
 #include "pruning.h"
-
-char hidden_options[]=" d n v Qbb QbB Qf Qg Qm Qr QR Qv Qx Qz TR E V Fa FA FC FD FS Ft FV Gt Q0 Q1 Q2 Q3 Q4 Q5 Q6 Q7 Q8 Q9 ";
+#include "dominance.h"
 
 #ifdef WIN32
 #ifdef __cplusplus 
@@ -20,6 +19,7 @@ char hidden_options[]=" d n v Qbb QbB Qf Qg Qm Qr QR Qv Qx Qz TR E V Fa FA FC FD
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <algorithm>
 
 
 #if __MWERKS__ && __POWERPC__
@@ -49,52 +49,85 @@ int isatty(int);  /* returns 1 if stdin is a tty
 #endif
 #endif
 
-// conduct half space intersection by invoking Qhull based on the data from rPtr and write results to wPtr
-int halfspace(FILE* rPtr, FILE* wPtr) {
+// conduct half space intersection by invoking Qhull on the halfspaces in hs (numhs rows, each row is the normal followed by the offset)
+// with the feasible point feasible_pt; the vertices of the intersection are stored in ext_pts and the indexes of the non-redundant halfspaces in hs_idx
+int halfspace(coordT* hs, int numhs, int dim, point_t* feasible_pt, vector<point_t*>& ext_pts, vector<int>& hs_idx) {
 	int curlong, totlong; /* used !qh_NOmem */
-	int exitcode, numpoints, dim;
+	int exitcode;
 	coordT *points;
-	boolT ismalloc;
-
-	// the required parameters
-  	int argc = 3;
-	char* argv[3];
-	argv[0] = "qhalf";
-	argv[1] = "Fp";
-	argv[2] = "Fx";
+	boolT ismalloc = True;
 
-	qh_init_A(rPtr, wPtr, stderr, argc, argv);  /* sets qh qhull_command */
+	qh_init_A(stdin, stdout, stderr, 0, NULL);  /* sets qh qhull_command */
 	exitcode= setjmp(qh errexit); /* simple statement for CRAY J916 */
 	if (!exitcode) {
 		qh NOerrexit = False;
 		qh_option("Halfspace", NULL, NULL);
 		qh HALFspace= True;    /* 'H'   */
-		qh_checkflags(qh qhull_command, hidden_options);
 		qh_initflags(qh qhull_command);
 
-		points= qh_readpoints(&numpoints, &dim, &ismalloc);
+		// the feasible point is freed by qh_freeqhull
+		qh feasible_point = (coordT*)qh_malloc(dim * sizeof(coordT));
+		for (int i = 0; i < dim; i++)
+			qh feasible_point[i] = feasible_pt->coord[i];
+		qh normal_size = dim * sizeof(coordT);
 
-		//for(int i = 0; i < numpoints; i++)
-		//{
-		//	for(int j = 0; j < dim; j++)
-		//	{
-		//		printf("%lf ", points[i* dim + j]);
-		//	}
-		//	printf("\n");
-		//}
+		// the dual points of the halfspaces
+		points = qh_sethalfspace_all(dim + 1, numhs, hs, qh feasible_point);
 
 		if (dim >= 5) {
 			qh_option("Qxact_merge", NULL, NULL);
 			qh MERGEexact= True; /* 'Qx' always */
 		}
-		qh_init_B(points, numpoints, dim, ismalloc);
+		qh_init_B(points, numhs, dim, ismalloc);
 		qh_qhull();
 		qh_check_output();
-		qh_produce_output();
-		//print_summary();
 
 		if (qh VERIFYoutput && !qh FORCEoutput && !qh STOPpoint && !qh STOPcone)
 			qh_check_points();
+
+		// the vertices of the intersection, one for each facet of the dual hull (as in option 'Fp')
+		facetT *facet;
+		FORALLfacets{
+			if (!facet->normal || facet->offset > 0)
+				continue;
+
+			bool zerodiv = false;
+			point_t* p = alloc_point(dim);
+			for (int k = 0; k < dim && !zerodiv; k++)
+			{
+				if (facet->offset < -qh MINdenom)
+					p->coord[k] = facet->normal[k] / -facet->offset + qh feasible_point[k];
+				else
+				{
+					boolT zd;
+					p->coord[k] = qh_divzero(facet->normal[k], facet->offset, qh MINdenom_1, &zd) + qh feasible_point[k];
+					zerodiv = zd;
+				}
+			}
+			if (zerodiv)
+			{
+				release_point(p);
+				continue;
+			}
+
+			// avoid very small numbers from round-off
+			for (int k = 0; k < dim; k++)
+			{
+				if (isZero(p->coord[k]))
+					p->coord[k] = 0;
+			}
+			ext_pts.push_back(p);
+		}
+
+		// the non-redundant halfspaces, sorted by index (as in option 'Fx')
+		vertexT *vertex;
+		FORALLvertices{
+			int id = qh_pointid(vertex->point);
+			if (id >= 0)
+				hs_idx.push_back(id);
+		}
+		sort(hs_idx.begin(), hs_idx.end());
+
 		exitcode= qh_ERRnone;
 	}
 	qh NOerrexit= True;  /* no more setjmp */
@@ -109,18 +142,13 @@ int halfspace(FILE* rPtr, FILE* wPtr) {
 	#endif
 
 	return exitcode;
-} /* main */
+}
 
-// get the set of extreme points of the candidate utility range R (bounded by the extreme vectors)
-vector<point_t*> get_extreme_pts(vector<point_t*>& ext_vec)
+// the hyperplanes bounding the candidate utility range R: the sum of the utilities and one per extreme vector
+static vector<hyperplane_t*> utility_hyperplanes(vector<point_t*>& ext_vec)
 {
 	int dim = ext_vec[0]->dim;
-	char file1[MAX_FILENAME_LENG];
-	sprintf(file1, "output/hyperplane_data");
-	char file2[MAX_FILENAME_LENG];
-	sprintf(file2, "output/ext_pt");
 
-	// construct the hyperplanes and a feasible point
 	vector<hyperplane_t*> utility_hyperplane;
 	point_t* normal;
 	normal = alloc_point(dim);
@@ -132,64 +160,76 @@ vector<point_t*> get_extreme_pts(vector<point_t*>& ext_vec)
 		normal = copy(ext_vec[i]);
 		utility_hyperplane.push_back( alloc_hyperplane(normal, 0));
 	}
-	point_t* feasible_pt = find_feasible(utility_hyperplane);
-
-	// prepare the file for computing the convex hull (the candidate utility range R) via half space interaction
-	write_hyperplanes(utility_hyperplane, feasible_pt, file1);
-	for(int i = 0; i < utility_hyperplane.size(); i++)
-		release_hyperplane(utility_hyperplane[i]);
+	return utility_hyperplane;
+}
 
-	// write hyperplanes and the feasible point to file1, conduct half space intersection and write reulsts to file2
-	FILE* rPtr;
-	FILE* wPtr;
-	if ((rPtr = fopen(file1, "r")) == NULL)
+// check whether the candidate utility range R has no interior point left
+bool is_empty_range(vector<point_t*>& ext_vec)
+{
+	vector<hyperplane_t*> utility_hyperplane = utility_hyperplanes(ext_vec);
+	point_t* feasible_pt = find_feasible(utility_hyperplane);
+	for(int i = 0; i < (int)utility_hyperplane.size(); i++)
 	{
-		fprintf(stderr, "Cannot open the data file.\n");
-		exit(0);
+		release_point(utility_hyperplane[i]->normal);
+		release_hyperplane(utility_hyperplane[i]);
 	}
-	wPtr = (FILE *)fopen(file2, "w");
-	halfspace(rPtr, wPtr);
-	fclose(rPtr);
-	fclose(wPtr);
+	if(feasible_pt == NULL)
+		return true;
+	release_point(feasible_pt);
+	return false;
+}
 
-	//read extreme points in file2
-	if ((rPtr = fopen(file2, "r")) == NULL)
+// get the set of extreme points of the candidate utility range R (bounded by the extreme vectors)
+vector<point_t*> get_extreme_pts(vector<point_t*>& ext_vec)
+{
+	int dim = ext_vec[0]->dim;
+
+	// construct the hyperplanes and a feasible point
+	vector<hyperplane_t*> utility_hyperplane = utility_hyperplanes(ext_vec);
+	point_t* feasible_pt = find_feasible(utility_hyperplane);
+
+	// the halfspaces for computing the convex hull (the candidate utility range R) via half space interaction
+	int numhs = utility_hyperplane.size();
+	coordT* hs = new coordT[numhs * (dim + 1)];
+	for(int i = 0; i < numhs; i++)
 	{
-		fprintf(stderr, "Cannot open the data file %s.\n", file2);
-		exit(0);
+		for(int j = 0; j < dim; j++)
+			hs[i * (dim + 1) + j] = utility_hyperplane[i]->normal->coord[j];
+		hs[i * (dim + 1) + dim] = utility_hyperplane[i]->offset;
+
+		release_point(utility_hyperplane[i]->normal);
+		release_hyperplane(utility_hyperplane[i]);
 	}
-	int size;
+
+	// conduct half space intersection
+	vector<point_t*> all_pts;
+	vector<int> hs_idx;
+	halfspace(hs, numhs, dim, feasible_pt, all_pts, hs_idx);
+	delete[] hs;
+	release_point(feasible_pt);
+
+	// the extreme points of R (the origin is not a utility vector)
 	vector<point_t*> ext_pts;
-	fscanf(rPtr, "%i%i", &dim, &size);
-	for (int i = 0; i < size; i++)
+	for (int i = 0; i < (int)all_pts.size(); i++)
 	{
 		bool allZero = true;
-		point_t* p = alloc_point(dim);
 		for (int j = 0; j < dim; j++)
 		{
-			fscanf(rPtr, "%lf", &p->coord[j]);
-			if(!isZero(p->coord[j]))
+			if(!isZero(all_pts[i]->coord[j]))
 				allZero = false;
 		}
 		if(allZero)
-			release_point(p);
+			release_point(all_pts[i]);
 		else
-		{
-			ext_pts.push_back(p);
-			//print_point(p);
-		}
+			ext_pts.push_back(all_pts[i]);
 	}
 
 	// update the set of extreme vectors
 	vector<point_t*> new_ext_vec;
-	fscanf(rPtr, "%i", &size);
-	for (int i = 0; i < size; i++)
+	for (int i = 0; i < (int)hs_idx.size(); i++)
 	{
-		int idx;
-		fscanf(rPtr, "%i", &idx);
-
-		if(idx > 0)
-			new_ext_vec.push_back(copy(ext_vec[idx - 1]));
+		if(hs_idx[i] > 0)
+			new_ext_vec.push_back(copy(ext_vec[hs_idx[i] - 1]));
 	}
 	for(int i = 0; i < ext_vec.size(); i++)
 	{
@@ -197,7 +237,6 @@ vector<point_t*> get_extreme_pts(vector<point_t*>& ext_vec)
 	}
 	ext_vec = new_ext_vec;
 
-	fclose(rPtr);
 	return ext_pts;
 }
 
@@ -394,19 +433,21 @@ void get_hyperplanes(vector<point_t*>& ext_vec, hyperplane_t*& hp, vector<point_
 }
 
 // hyperplane pruning
-int hyperplane_dom(point_t* p_i, point_t* p_j, vector<point_t*> ext_pts)
+int hyperplane_dom(point_t* p_i, point_t* p_j, const vector<point_t*>& ext_pts)
 {
 	int dim = p_i->dim;
-
-	point_t* normal = sub(p_i, p_j);
+	const COORD_TYPE* c_i = p_i->coord;
+	const COORD_TYPE* c_j = p_j->coord;
 	
 	int below_count = 0;
 
-	// to perform hyperplane pruning, check each extreme points of R
+	// to perform hyperplane pruning, check each extreme points of R against the normal p_i - p_j
 	for(int i = 0; i < ext_pts.size(); i++)
 	{
-		point_t* ext_pt = ext_pts[i];
-		double v = dot_prod(normal, ext_pt);
+		const COORD_TYPE* ext_pt = ext_pts[i]->coord;
+		double v = 0;
+		for(int k = 0; k < dim; k++)
+			v += (c_i[k] - c_j[k]) * ext_pt[k];
 
 		if(v < 0 & !isZero(v))
 		{
@@ -414,7 +455,6 @@ int hyperplane_dom(point_t* p_i, point_t* p_j, vector<point_t*> ext_pts)
 			break;
 		}
 	}
-	release_point(normal);
 
 	if (below_count == 0)
 		return 1;
@@ -423,7 +463,7 @@ int hyperplane_dom(point_t* p_i, point_t* p_j, vector<point_t*> ext_pts)
 }
 
 // conical hull pruning
-int conical_hull_dom(point_t* p_i, point_t* p_j, hyperplane_t* hp, vector<point_t*> hyperplanes, vector<point_t*> ext_vec)
+int conical_hull_dom(point_t* p_i, point_t* p_j, hyperplane_t* hp, const vector<point_t*>& hyperplanes, const vector<point_t*>& ext_vec)
 {
 	int dim = p_i->dim;
 	int dominate;
@@ -464,7 +504,7 @@ int conical_hull_dom(point_t* p_i, point_t* p_j, hyperplane_t* hp, vector<point_
 }
 
 // check whether p_i has a higher uitlity than p_j based on either Hyperplane Prunning or Conical Hull Pruninig (defined by dom_option)
-int dom(point_t* p_i, point_t* p_j, vector<point_t*> ext_pts, hyperplane_t* hp, vector<point_t*> hyperplanes, vector<point_t*> ext_vec, int dom_option)
+int dom(point_t* p_i, point_t* p_j, const vector<point_t*>& ext_pts, hyperplane_t* hp, const vector<point_t*>& hyperplanes, const vector<point_t*>& ext_vec, int dom_option)
 {
 	if(dom_option == HYPER_PLANE) // hyperplane pruning
 		return hyperplane_dom(p_i, p_j, ext_pts);
@@ -472,6 +512,83 @@ int dom(point_t* p_i, point_t* p_j, vector<point_t*> ext_pts, hyperplane_t* hp,
 		return conical_hull_dom(p_i, p_j, hp, hyperplanes, ext_vec);
 }
 
+// Hyperplane Pruning in matrix form. With the extreme points of R as the rows of a matrix E, p_i dominates p_j
+// if (p_i - p_j) . e > -EQN_EPS for every extreme point e, that is, if E p_i >= E p_j - EQN_EPS entry-wise.
+// The candidates are projected once per round, and a point is then compared with the whole skyline window
+// by the kernels of dominance.h, DOMINANCE_BLOCK window points at a time and without allocation.
+typedef struct ext_projection
+{
+	int						k;			// the number of extreme points
+	int						dim;
+	vector<double>			E;			// the extreme points, row-major
+	vector<double>			values;		// the projections of the candidates, k entries each
+	vector<const double*>	rows;		// rows[i]: the projection of P->points[i], for the candidates i
+	vector<double>			shifted;	// scratch: a projection shifted by EQN_EPS
+
+}	ext_projection_t;
+
+// u = E p
+static void project(const ext_projection_t& proj, const COORD_TYPE* p, double* u)
+{
+	for (int e = 0; e < proj.k; e++)
+	{
+		const double* ext_pt = &proj.E[(size_t)e * proj.dim];
+		double v = 0;
+		for (int i = 0; i < proj.dim; i++)
+			v += ext_pt[i] * p[i];
+		u[e] = v;
+	}
+}
+
+// project the candidates C_idx of P on the extreme points ext_pts
+static void init_projection(ext_projection_t& proj, point_set_t* P, const vector<int>& C_idx, const vector<point_t*>& ext_pts)
+{
+	proj.k = ext_pts.size();
+	proj.dim = P->points[0]->dim;
+	proj.E.resize((size_t)proj.k * proj.dim);
+	for (int e = 0; e < proj.k; e++)
+		for (int i = 0; i < proj.dim; i++)
+			proj.E[(size_t)e * proj.dim + i] = ext_pts[e]->coord[i];
+
+	proj.values.resize((size_t)C_idx.size() * proj.k + 1);
+	proj.rows.assign(P->numberOfPoints, NULL);
+	for (int i = 0; i < (int)C_idx.size(); i++)
+	{
+		double* u = &proj.values[(size_t)i * proj.k];
+		project(proj, P->points[C_idx[i]]->coord, u);
+		proj.rows[C_idx[i]] = u;
+	}
+	proj.shifted.resize(proj.k + 1);
+}
+
+// check whether the point with projection u is dominated by some point of the window sl[0..count)
+static bool window_dominated(ext_projection_t& proj, const double* u, const int* sl, int count)
+{
+	for (int e = 0; e < proj.k; e++)
+		proj.shifted[e] = u[e] - EQN_EPS;
+	for (int j = 0; j < count; j += DOMINANCE_BLOCK)
+		if (dominated_by_mask(proj.shifted.data(), proj.rows.data(), sl + j, min(count - j, DOMINANCE_BLOCK), proj.k))
+			return true;
+	return false;
+}
+
+// remove the points of the window sl[0..count) dominated by the point with projection u, returning the new count
+static int window_evict(ext_projection_t& proj, const double* u, int* sl, int count)
+{
+	for (int e = 0; e < proj.k; e++)
+		proj.shifted[e] = u[e] + EQN_EPS;
+	int index = 0;
+	for (int j = 0; j < count; j += DOMINANCE_BLOCK)
+	{
+		int block = min(count - j, DOMINANCE_BLOCK);
+		uint64_t mask = dominates_mask(proj.shifted.data(), proj.rows.data(), sl + j, block, proj.k);
+		for (int b = 0; b < block; b++)
+			if (!(mask >> b & 1))
+				sl[index++] = sl[j + b];
+	}
+	return index;
+}
+
 // get an approximate upper bound bound in O(|ext_pts|) time based on the MBR of R
 double get_rrbound_approx(vector<point_t*> ext_pts)
 {
@@ -546,6 +663,9 @@ double get_rrbound_exact(vector<point_t*> ext_pts)
 // rr: the upper bound of the regret ratio
 // stop_option: the stopping condition, which can be NO_BOUND, EXACT_BOUND and APPROX_BOUND
 // dom_option: the skyline options, which can be SQL or RTREE
+// R only shrinks across rounds, but each answer cuts off the witness extreme point of about half of the
+// candidate pairs that are not dominated, so the candidates are retested against all extreme points of R:
+// keeping the witnesses of the pairs across rounds cost more than the tests it saved
 void sql_pruning(point_set_t* P, vector<int>& C_idx, vector<point_t*>& ext_vec, double& rr, int stop_option, int dom_option)
 {
 	int dim = P->points[0]->dim;
@@ -582,6 +702,10 @@ void sql_pruning(point_set_t* P, vector<int>& C_idx, vector<point_t*>& ext_vec,
 	//print_point(hp->normal);
 
 
+	ext_projection_t proj;
+	if(dom_option == HYPER_PLANE)
+		init_projection(proj, P, C_idx, ext_pts);
+
 	// run the adapted squential skyline algorihtm
 	int* sl = new int[C_idx.size()];
 	int index = 0;
@@ -593,23 +717,33 @@ void sql_pruning(point_set_t* P, vector<int>& C_idx, vector<point_t*>& ext_vec,
 		point_t* pt = P->points[C_idx[i]];
 
 		// check if pt is dominated by the skyline so far   
-		for (int j = 0; j < index && !dominated; ++j)
+		if(dom_option == HYPER_PLANE)
+			dominated = window_dominated(proj, proj.rows[C_idx[i]], sl, index);
+		else
 		{
+			for (int j = 0; j < index && !dominated; ++j)
+			{
 
-			if(dom(P->points[ sl[j] ], pt, ext_pts, hp, hyperplanes, ext_vec, dom_option))
-				dominated = 1;
+				if(dom(P->points[ sl[j] ], pt, ext_pts, hp, hyperplanes, ext_vec, dom_option))
+					dominated = 1;
+			}
 		}
 
 		if (!dominated)
 		{
 			// eliminate any points in current skyline that it dominates
-			int m = index;
-			index = 0;
-			for (int j = 0; j < m; ++j)
+			if(dom_option == HYPER_PLANE)
+				index = window_evict(proj, proj.rows[C_idx[i]], sl, index);
+			else
 			{
+				int m = index;
+				index = 0;
+				for (int j = 0; j < m; ++j)
+				{
 
-				if(!dom(pt, P->points[sl[j]], ext_pts, hp, hyperplanes, ext_vec, dom_option))
-					sl[index++] = sl[j];
+					if(!dom(pt, P->points[sl[j]], ext_pts, hp, hyperplanes, ext_vec, dom_option))
+						sl[index++] = sl[j];
+				}
 			}
 
 			// add this point as well
@@ -637,6 +771,52 @@ void sql_pruning(point_set_t* P, vector<int>& C_idx, vector<point_t*>& ext_vec,
 	
 }
 
+// build the R-tree over the candidates C_idx of P
+// the leaf entries are labelled with the indexes in P, so that the tree stays valid as C_idx shrinks
+candidate_rtree_t* alloc_candidate_rtree(point_set_t* P, vector<int>& C_idx)
+{
+	candidate_rtree_t* tree = new candidate_rtree_t;
+
+	// parameters for building the R-trees
+	tree->aInfo = (rtree_info *)malloc(sizeof(rtree_info));
+	memset(tree->aInfo, 0, sizeof(rtree_info));
+	tree->aInfo->m = 18;
+	tree->aInfo->M = 36;
+	tree->aInfo->dim = P->points[0]->dim;
+	tree->aInfo->reinsert_p = 27;
+	tree->aInfo->no_histogram = C_idx.size();
+
+	// construct R-tree
+	tree->root = contructRtree(P, C_idx, tree->aInfo);
+
+	vector<node_type*> leaves;
+	collect_leaves(tree->root, leaves, tree->aInfo);
+	tree->leaf.assign(P->numberOfPoints, NULL);
+	for (int i = 0; i < (int)leaves.size(); i++)
+	{
+		leaves[i]->id = C_idx[leaves[i]->id];
+		tree->leaf[leaves[i]->id] = leaves[i];
+	}
+	return tree;
+}
+
+// free the R-tree
+void release_candidate_rtree(candidate_rtree_t* tree)
+{
+	release_rtree(tree->root, tree->aInfo);
+	free(tree->aInfo);
+	delete tree;
+}
+
+// use the branch-and-bound skyline (BBS) algorithm for maintaining the candidate set
+// the R-tree is built for this call only; see the overload below for keeping it across rounds
+void rtree_pruning(point_set_t* P, vector<int>& C_idx, vector<point_t*>& ext_vec, double& rr,  int stop_option, int dom_option)
+{
+	candidate_rtree_t* tree = alloc_candidate_rtree(P, C_idx);
+	rtree_pruning(P, C_idx, ext_vec, rr, stop_option, dom_option, tree);
+	release_candidate_rtree(tree);
+}
+
 // use the branch-and-bound skyline (BBS) algorithm for maintaining the candidate set
 // P: the input car set
 // C_idx: the indexes of the current candidate favorite car in P
@@ -644,7 +824,8 @@ void sql_pruning(point_set_t* P, vector<int>& C_idx, vector<point_t*>& ext_vec,
 // rr: the upper bound of the regret ratio
 // stop_option: the stopping condition, which can be NO_BOUND, EXACT_BOUND and APPROX_BOUND
 // dom_option: the skyline options, which can be SQL or RTREE
-void rtree_pruning(point_set_t* P, vector<int>& C_idx, vector<point_t*>& ext_vec, double& rr,  int stop_option, int dom_option)
+// tree: the R-tree over (a superset of) C_idx; the points no longer in C_idx are deleted from it
+void rtree_pruning(point_set_t* P, vector<int>& C_idx, vector<point_t*>& ext_vec, double& rr,  int stop_option, int dom_option, candidate_rtree_t* tree)
 {
 	vector<point_t*> ext_pts;
 	vector<point_t*> hyperplanes;
@@ -668,31 +849,42 @@ void rtree_pruning(point_set_t* P, vector<int>& C_idx, vector<point_t*>& ext_vec
 	else 
 		rr = 1;
 
-	// parameters for building the R-trees
-	rtree_info *aInfo;
-	aInfo = (rtree_info *)malloc(sizeof(rtree_info));
-	memset(aInfo, 0, sizeof(rtree_info));
-	aInfo->m = 18;
-	aInfo->M = 36;
-	aInfo->dim = P->points[0]->dim;
-	aInfo->reinsert_p = 27;
-	aInfo->no_histogram = C_idx.size();
+	// delete the points that left the candidate set since the last round
+	rtree_info *aInfo = tree->aInfo;
+	vector<bool> candidate(P->numberOfPoints, false);
+	for (int i = 0; i < (int)C_idx.size(); i++)
+		candidate[C_idx[i]] = true;
+	for (int i = 0; i < P->numberOfPoints; i++)
+	{
+		if (tree->leaf[i] != NULL && !candidate[i])
+		{
+			delete_node(tree->root, tree->leaf[i], aInfo);
+			tree->leaf[i] = NULL;
+		}
+	}
+	node_type *root = tree->root;
 
-	// construct R-tree
-	node_type *root = contructRtree(P, C_idx, aInfo);
+	ext_projection_t proj;
+	vector<double> corner;
+	if(dom_option == HYPER_PLANE)
+	{
+		init_projection(proj, P, C_idx, ext_pts);
+		corner.resize(proj.k + 1);
+	}
 
-	priority_queue<node_type*, vector<node_type*>, nodeCmp> heap;
+	priority_queue<bbs_entry_t, vector<bbs_entry_t>, nodeCmp> heap;
 
-	heap.push(root);
+	heap.push(bbs_entry_t(root));
 
 	int* sl = new int[C_idx.size()];
 	int index = 0;
 	int dim = aInfo->dim;
+	point_t* TRpt = alloc_point(dim);
 
 	// run the adapted BBS algorihtm
 	while (!heap.empty())
 	{
-		node_type* n = heap.top();
+		node_type* n = heap.top().node;
 		heap.pop();
 
 		if (n->attribute != LEAF)
@@ -700,17 +892,24 @@ void rtree_pruning(point_set_t* P, vector<int>& C_idx, vector<point_t*>& ext_vec
 			
 			int dominated = 0;
 			
-			point_t* TRpt = alloc_point(dim);
-			for (int i = 0; i < dim; i++)
-				TRpt->coord[i] = n->b[i];
-
 			// check if TRpt is dominated by the skyline so far   
-			for (int j = 0; j < index && !dominated; ++j)
+			if(dom_option == HYPER_PLANE)
 			{
+				project(proj, n->b, corner.data());
+				dominated = window_dominated(proj, corner.data(), sl, index);
+			}
+			else
+			{
+				for (int i = 0; i < dim; i++)
+					TRpt->coord[i] = n->b[i];
+
+				for (int j = 0; j < index && !dominated; ++j)
+				{
 				
-				if(dom(P->points[ sl[j] ], TRpt, ext_pts, hp, hyperplanes, ext_vec, dom_option))
-					dominated = 1;
+					if(dom(P->points[ sl[j] ], TRpt, ext_pts, hp, hyperplanes, ext_vec, dom_option))
+						dominated = 1;
 
+				}
 			}
 
 
@@ -728,7 +927,7 @@ void rtree_pruning(point_set_t* P, vector<int>& C_idx, vector<point_t*>& ext_vec
 					//		child_dominated = 1;
 					//
 					//if(!child_dominated)
-					heap.push(n->ptr[i]);
+					heap.push(bbs_entry_t(n->ptr[i]));
 				}
 			}
 				
@@ -739,25 +938,35 @@ void rtree_pruning(point_set_t* P, vector<int>& C_idx, vector<point_t*>& ext_vec
 			//S = updateS(id, C, S, V);
 
 			int dominated = 0;
-			for (int j = 0; j < index && !dominated; ++j)
+			if(dom_option == HYPER_PLANE)
+				dominated = window_dominated(proj, proj.rows[idx], sl, index);
+			else
 			{
-				if(dom(P->points[ sl[j] ], P->points[ C_idx[idx] ], ext_pts, hp, hyperplanes, ext_vec, dom_option))
-					dominated = 1;
+				for (int j = 0; j < index && !dominated; ++j)
+				{
+					if(dom(P->points[ sl[j] ], P->points[idx], ext_pts, hp, hyperplanes, ext_vec, dom_option))
+						dominated = 1;
+				}
 			}
 			if (dominated)
 				continue;
 
 			// eliminate any points in current skyline that it dominates
-			int m = index;
-			index = 0;
-			for (int j = 0; j < m; ++j)
+			if(dom_option == HYPER_PLANE)
+				index = window_evict(proj, proj.rows[idx], sl, index);
+			else
 			{
-				if(!dom(P->points[C_idx[idx]], P->points[sl[j]], ext_pts, hp, hyperplanes, ext_vec, dom_option))
-					sl[index++] = sl[j];
+				int m = index;
+				index = 0;
+				for (int j = 0; j < m; ++j)
+				{
+					if(!dom(P->points[idx], P->points[sl[j]], ext_pts, hp, hyperplanes, ext_vec, dom_option))
+						sl[index++] = sl[j];
+				}
 			}
 
 			// add this point as well
-			sl[index++] = C_idx[idx];
+			sl[index++] = idx;
 		}
 	}
 	
@@ -766,7 +975,7 @@ void rtree_pruning(point_set_t* P, vector<int>& C_idx, vector<point_t*>& ext_vec
 	for(int i = 0; i < index; i++)
 		C_idx.push_back(sl[i]);
 	delete[] sl;
-	free(aInfo);
+	release_point(TRpt);
 	if(dom_option == HYPER_PLANE)
 	{
 		for(int i = 0; i < ext_pts.size(); i++)
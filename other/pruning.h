@@ -29,10 +29,31 @@ using namespace std;
 // get the set of extreme points of the candidate utility range R (bounded by the extreme vectors)
 vector<point_t*> get_extreme_pts(vector<point_t*>& ext_vec);
 
+// check whether the candidate utility range R (bounded by the extreme vectors) has no interior point left
+bool is_empty_range(vector<point_t*>& ext_vec);
+
 // use the seqentail way for maintaining the candidate set
 void sql_pruning(point_set_t* P, vector<int>& C_idx, vector<point_t*>& ext_vec, double& rr, int stop_option, int dom_option);
 
+// the R-tree over the candidate set, built once and kept across the rounds of rtree_pruning
+typedef struct candidate_rtree
+{
+	rtree_info*				aInfo;
+	node_type*				root;
+	vector<node_type*>		leaf;	// leaf[i]: the leaf entry of P->points[i], NULL once it is no longer a candidate
+
+}	candidate_rtree_t;
+
+// build the R-tree over the candidates C_idx of P
+candidate_rtree_t* alloc_candidate_rtree(point_set_t* P, vector<int>& C_idx);
+
+// free the R-tree
+void release_candidate_rtree(candidate_rtree_t* tree);
+
 // use the branch-and-bound skyline (BBS) algorithm for maintaining the candidate set
 void rtree_pruning(point_set_t* P, vector<int>& C_idx, vector<point_t*>& ext_vec, double& rr,  int stop_option, int dom_option);
 
+// use the BBS algorithm on a persistent R-tree, deleting from it the points no longer in C_idx
+void rtree_pruning(point_set_t* P, vector<int>& C_idx, vector<point_t*>& ext_vec, double& rr,  int stop_option, int dom_option, candidate_rtree_t* tree);
+
 #endif
\ No newline at end of file
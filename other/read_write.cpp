@@ -1,5 +1,384 @@
 #include "read_write.h"
 #include "operation.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+// round offset up to the alignment of a section in the binary dataset format
+static uint64_t align_offset(uint64_t offset)
+{
+	return (offset + STORE_ALIGNMENT - 1) / STORE_ALIGNMENT * STORE_ALIGNMENT;
+}
+
+// check whether the file is in the binary dataset format
+bool is_binary_dataset(char* input)
+{
+	FILE* c_fp = fopen(input, "rb");
+	if (c_fp == NULL)
+		return false;
+
+	char magic[8];
+	bool binary = fread(magic, 1, sizeof(magic), c_fp) == sizeof(magic) && memcmp(magic, DATASET_MAGIC, sizeof(magic)) == 0;
+
+	fclose(c_fp);
+	return binary;
+}
+
+// map a dataset in the binary format into memory
+// The mapping is read-only: the points are stored normalized, so its pages stay shared through the page cache
+// between all processes mapping the file, and the ranges for raw_coord are read from the file as well.
+// NULL if the file is missing or malformed.
+point_set_t* load_points_binary(char* input)
+{
+	int fd = open(input, O_RDONLY);
+	if (fd < 0)
+	{
+		fprintf(stderr, "Cannot open the data file %s.\n", input);
+		return NULL;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(dataset_header_t))
+	{
+		fprintf(stderr, "Invalid data file %s.\n", input);
+		close(fd);
+		return NULL;
+	}
+
+	size_t size = st.st_size;
+	void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED)
+	{
+		fprintf(stderr, "Cannot map the data file %s.\n", input);
+		return NULL;
+	}
+
+	// a section of len bytes at offset lies within the file
+	auto fits = [size](uint64_t offset, uint64_t len) { return offset <= size && len <= size - offset; };
+
+	dataset_header_t* header = (dataset_header_t*)mapping;
+	uint64_t n = header->numberOfPoints, dim = header->dim;
+	if (memcmp(header->magic, DATASET_MAGIC, sizeof(header->magic)) != 0 || header->version != DATASET_VERSION ||
+		n == 0 || dim == 0 || !fits(header->min_offset, dim * sizeof(double)) || !fits(header->max_offset, dim * sizeof(double)) ||
+		!fits(header->id_offset, n * sizeof(int32_t)) || !fits(header->coord_offset, n * dim * sizeof(COORD_TYPE)) ||
+		header->min_offset % sizeof(double) != 0 || header->max_offset % sizeof(double) != 0 ||
+		header->coord_offset % STORE_ALIGNMENT != 0)
+	{
+		fprintf(stderr, "Invalid data file %s (version %u).\n", input, header->version);
+		munmap(mapping, size);
+		return NULL;
+	}
+
+	point_store_t* store = map_point_store(n, dim, mapping, size, header->coord_offset);
+	store->min = (COORD_TYPE*)((char*)mapping + header->min_offset);
+	store->max = (COORD_TYPE*)((char*)mapping + header->max_offset);
+	int32_t* ids = (int32_t*)((char*)mapping + header->id_offset);
+	for (uint64_t i = 0; i < n; i++)
+		store->rows[i].id = ids[i];
+	index_point_store(store);
+
+	return alloc_point_set(store);
+}
+
+// map a dataset in the binary format into memory, exiting if the file is missing or malformed
+point_set_t* read_points_binary(char* input)
+{
+	point_set_t* point_set = load_points_binary(input);
+	if (point_set == NULL)
+		exit(0);
+	return point_set;
+}
+
+// write a point set in the binary dataset format, normalizing it first if it has not been
+void write_points_binary(point_set_t* point_set, char* output)
+{
+	int n = point_set->numberOfPoints;
+	int dim = n > 0 ? point_set->points[0]->dim : 0;
+	if (n > 0)
+		linear_normalize(point_set);
+
+	dataset_header_t header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, DATASET_MAGIC, sizeof(header.magic));
+	header.version = DATASET_VERSION;
+	header.numberOfPoints = n;
+	header.dim = dim;
+	header.min_offset = align_offset(sizeof(header));
+	header.max_offset = align_offset(header.min_offset + dim * sizeof(double));
+	header.id_offset = align_offset(header.max_offset + dim * sizeof(double));
+	header.coord_offset = align_offset(header.id_offset + n * sizeof(int32_t));
+
+	// the raw range of each dimension, for raw_coord
+	vector<double> min(dim, 0), max(dim, 0);
+	for (int i = 0; i < dim; i++)
+	{
+		min[i] = point_set->store != NULL ? point_set->store->min[i] : 0;
+		max[i] = point_set->store != NULL ? point_set->store->max[i] : 1;
+	}
+
+	FILE* wPtr = fopen(output, "wb");
+	if (wPtr == NULL)
+	{
+		fprintf(stderr, "Cannot open the output file %s.\n", output);
+		exit(0);
+	}
+
+	// write a section at its offset, padding with zeros up to it
+	uint64_t pos = 0;
+	char zeros[STORE_ALIGNMENT] = {0};
+	auto write_at = [&](uint64_t offset, const void* data, size_t len)
+	{
+		fwrite(zeros, 1, offset - pos, wPtr);
+		fwrite(data, 1, len, wPtr);
+		pos = offset + len;
+	};
+
+	write_at(0, &header, sizeof(header));
+	write_at(header.min_offset, min.data(), dim * sizeof(double));
+	write_at(header.max_offset, max.data(), dim * sizeof(double));
+
+	vector<int32_t> ids(n);
+	for (int j = 0; j < n; j++)
+		ids[j] = point_set->points[j]->id;
+	write_at(header.id_offset, ids.data(), n * sizeof(int32_t));
+
+	fwrite(zeros, 1, header.coord_offset - pos, wPtr);
+	for (int j = 0; j < n; j++)
+		fwrite(point_set->points[j]->coord, sizeof(COORD_TYPE), dim, wPtr);
+
+	if (ferror(wPtr) || fclose(wPtr) != 0)
+	{
+		fprintf(stderr, "Cannot write the output file %s.\n", output);
+		exit(0);
+	}
+}
+
+// 64-bit FNV-1a hash and size of the content of a file; false if it cannot be read
+static bool hash_file(char* input, uint64_t* hash, uint64_t* size)
+{
+	FILE* c_fp = fopen(input, "rb");
+	if (c_fp == NULL)
+		return false;
+
+	uint64_t h = 14695981039346656037ULL, total = 0;
+	unsigned char buffer[1 << 16];
+	size_t k;
+	while ((k = fread(buffer, 1, sizeof(buffer), c_fp)) > 0)
+	{
+		for (size_t i = 0; i < k; i++)
+			h = (h ^ buffer[i]) * 1099511628211ULL;
+		total += k;
+	}
+
+	bool ok = !ferror(c_fp);
+	fclose(c_fp);
+	*hash = h;
+	*size = total;
+	return ok;
+}
+
+// the cache file of a dataset: <dataset>.cache, or <basename of dataset>.cache in DATASET_CACHE_DIR if it is set
+static string cache_path(char* input)
+{
+	const char* dir = getenv("DATASET_CACHE_DIR");
+	if (dir == NULL || *dir == '\0')
+		return string(input) + ".cache";
+
+	const char* base = strrchr(input, '/');
+	return string(dir) + "/" + (base != NULL ? base + 1 : input) + ".cache";
+}
+
+// map the cache file at path if it holds the dataset with the given size and hash, NULL otherwise; with hash NULL, the
+// cache file must instead carry the modification time mtime of the dataset (see stamp_cache)
+// The mapping is read-only, as for the binary dataset format, so the processes using a dataset share its pages.
+static point_set_t* map_cache(const char* path, const uint64_t* hash, uint64_t source_size, time_t mtime, int* numberOfSourcePoints)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(cache_header_t) || (hash == NULL && (mtime == 0 || st.st_mtime != mtime)))
+	{
+		close(fd);
+		return NULL;
+	}
+
+	size_t size = st.st_size;
+	void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED)
+		return NULL;
+
+	// a section of len bytes at offset lies within the file
+	auto fits = [size](uint64_t offset, uint64_t len) { return offset <= size && len <= size - offset; };
+
+	cache_header_t* header = (cache_header_t*)mapping;
+	uint64_t n = header->numberOfPoints, dim = header->dim;
+	if (memcmp(header->magic, CACHE_MAGIC, sizeof(header->magic)) != 0 || header->version != CACHE_VERSION ||
+		header->preprocess != CACHE_PREPROCESS || (hash != NULL && header->source_hash != *hash) || header->source_size != source_size ||
+		n == 0 || dim == 0 || !fits(header->min_offset, dim * sizeof(double)) || !fits(header->max_offset, dim * sizeof(double)) ||
+		!fits(header->id_offset, n * sizeof(int32_t)) || !fits(header->coord_offset, n * dim * sizeof(COORD_TYPE)) ||
+		header->min_offset % sizeof(double) != 0 || header->max_offset % sizeof(double) != 0 ||
+		header->coord_offset % STORE_ALIGNMENT != 0)
+	{
+		munmap(mapping, size);
+		return NULL;
+	}
+
+	point_store_t* store = map_point_store(n, dim, mapping, size, header->coord_offset);
+	store->min = (COORD_TYPE*)((char*)mapping + header->min_offset);
+	store->max = (COORD_TYPE*)((char*)mapping + header->max_offset);
+	int32_t* ids = (int32_t*)((char*)mapping + header->id_offset);
+	for (uint64_t i = 0; i < n; i++)
+		store->rows[i].id = ids[i];
+	index_point_store(store);
+
+	*numberOfSourcePoints = header->numberOfSourcePoints;
+	return alloc_point_set(store);
+}
+
+// give the cache file at path the modification time mtime of its dataset, which was hashed at hashed_at, so that a later
+// start can take the cache without hashing the dataset again. A dataset modified in the second it was hashed in could
+// change again without a new modification time; its cache gets time 0 and the dataset is hashed on every start.
+static void stamp_cache(const char* path, time_t mtime, time_t hashed_at)
+{
+	struct timeval times[2] = {{0, 0}, {0, 0}};
+	if (mtime < hashed_at)
+		times[0].tv_sec = times[1].tv_sec = mtime;
+	utimes(path, times);
+}
+
+// write the cache file of a dataset; it is written aside and renamed, so readers never see a partial file
+static void write_cache(const string& path, point_set_t* skyline, uint64_t hash, uint64_t source_size, time_t mtime, time_t hashed_at, int numberOfSourcePoints)
+{
+	point_store_t* store = skyline->store;
+	int n = store->numberOfPoints, dim = store->dim;
+
+	cache_header_t header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+	header.version = CACHE_VERSION;
+	header.preprocess = CACHE_PREPROCESS;
+	header.source_hash = hash;
+	header.source_size = source_size;
+	header.numberOfSourcePoints = numberOfSourcePoints;
+	header.numberOfPoints = n;
+	header.dim = dim;
+	header.min_offset = align_offset(sizeof(header));
+	header.max_offset = align_offset(header.min_offset + dim * sizeof(double));
+	header.id_offset = align_offset(header.max_offset + dim * sizeof(double));
+	header.coord_offset = align_offset(header.id_offset + n * sizeof(int32_t));
+
+	string temp = path + "." + to_string(getpid()) + ".tmp";
+	FILE* wPtr = fopen(temp.c_str(), "wb");
+	if (wPtr == NULL)
+		return;
+
+	// write a section at its offset, padding with zeros up to it
+	uint64_t pos = 0;
+	char zeros[STORE_ALIGNMENT] = {0};
+	auto write_at = [&](uint64_t offset, const void* data, size_t len)
+	{
+		fwrite(zeros, 1, offset - pos, wPtr);
+		fwrite(data, 1, len, wPtr);
+		pos = offset + len;
+	};
+
+	vector<int32_t> ids(n);
+	for (int j = 0; j < n; j++)
+		ids[j] = store->rows[j].id;
+
+	write_at(0, &header, sizeof(header));
+	write_at(header.min_offset, store->min, dim * sizeof(double));
+	write_at(header.max_offset, store->max, dim * sizeof(double));
+	write_at(header.id_offset, ids.data(), n * sizeof(int32_t));
+	write_at(header.coord_offset, store->coord, (size_t)n * dim * sizeof(COORD_TYPE));
+
+	// a cache that cannot be written is only a missed speedup
+	bool failed = ferror(wPtr) != 0;
+	if (fclose(wPtr) != 0)
+		failed = true;
+	if (!failed)
+		stamp_cache(temp.c_str(), mtime, hashed_at);
+	if (failed || rename(temp.c_str(), path.c_str()) != 0)
+		unlink(temp.c_str());
+}
+
+// read a dataset, normalize it and compute its skyline, through the cache file of the dataset
+// The result holds the skyline points only, in the order of skyline_point, with the raw ranges of the dataset so that
+// raw_coord works on it. A cache file is used if it was computed from a dataset with the same content and by the same
+// preprocessing; otherwise the skyline is computed and the cache file rewritten. The content is only hashed if the size
+// or the modification time of the dataset differ from those the cache file was written for.
+// NULL if the dataset is missing or malformed.
+point_set_t* load_skyline(char* input, int* numberOfSourcePoints)
+{
+	uint64_t hash = 0, size = 0;
+	bool hashed = false;
+	time_t mtime = 0, hashed_at = 0;
+	string path = cache_path(input);
+	struct stat st;
+	if (stat(input, &st) == 0)
+	{
+		mtime = st.st_mtime;
+		point_set_t* cached = map_cache(path.c_str(), NULL, st.st_size, mtime, numberOfSourcePoints);
+		if (cached != NULL)
+			return cached;
+
+		hashed_at = time(NULL);
+		hashed = hash_file(input, &hash, &size);
+	}
+	if (hashed)
+	{
+		point_set_t* cached = map_cache(path.c_str(), &hash, size, 0, numberOfSourcePoints);
+		if (cached != NULL)
+		{
+			// the same content under a new modification time, e.g. a copy of the dataset
+			stamp_cache(path.c_str(), mtime, hashed_at);
+			return cached;
+		}
+	}
+
+	point_set_t* P = load_points(input);
+	if (P == NULL)
+		return NULL;
+	*numberOfSourcePoints = P->numberOfPoints;
+	linear_normalize(P);
+	point_set_t* skyline = skyline_point(P);
+
+	// keep the skyline rows contiguous, so the dataset can be released
+	int n = skyline->numberOfPoints, dim = P->points[0]->dim;
+	point_set_t* result = alloc_point_set(n, dim);
+	for (int i = 0; i < n; i++)
+	{
+		result->points[i]->id = skyline->points[i]->id;
+		memcpy(result->points[i]->coord, skyline->points[i]->coord, dim * sizeof(COORD_TYPE));
+	}
+	index_point_store(result->store);
+	result->store->min = (COORD_TYPE*)malloc(dim * sizeof(COORD_TYPE));
+	result->store->max = (COORD_TYPE*)malloc(dim * sizeof(COORD_TYPE));
+	memcpy(result->store->min, P->store->min, dim * sizeof(COORD_TYPE));
+	memcpy(result->store->max, P->store->max, dim * sizeof(COORD_TYPE));
+
+	release_point_set(skyline, false);
+	release_point_set(P, true);
+
+	if (hashed)
+		write_cache(path, result, hash, size, mtime, hashed_at, *numberOfSourcePoints);
+	return result;
+}
+
+// read a dataset, normalize it and compute its skyline as load_skyline does, exiting if the dataset is missing or malformed
+point_set_t* read_skyline(char* input, int* numberOfSourcePoints)
+{
+	point_set_t* skyline = load_skyline(input, numberOfSourcePoints);
+	if (skyline == NULL)
+		exit(0);
+	return skyline;
+}
 
 // // read points from the input file
 // point_set_t* read_points(char* input)
@@ -4,6 +4,56 @@
 #include "data_struct.h"
 #include "data_utility.h"
 #include "operation.h"
+#include <stdint.h>
+
+#define DATASET_MAGIC		"PTSTORE"
+#define DATASET_VERSION		2
+
+// header of the binary dataset format.
+// Every section starts at a multiple of STORE_ALIGNMENT bytes so that the file can be mapped and used in place.
+// The points are stored normalized by linear_normalize, so the mapping is never written and its pages stay
+// shared between the processes using the dataset; raw_coord derives the raw values from the stored ranges.
+typedef struct dataset_header
+{
+	char		magic[8];			// DATASET_MAGIC
+	uint32_t	version;			// DATASET_VERSION
+	uint32_t	numberOfPoints;
+	uint32_t	dim;
+	uint32_t	reserved;
+
+	uint64_t	min_offset;			// dim doubles, the minimum raw value of each dimension
+	uint64_t	max_offset;			// dim doubles, the maximum raw value of each dimension
+	uint64_t	id_offset;			// numberOfPoints int32 ids
+	uint64_t	coord_offset;		// numberOfPoints * dim doubles, the normalized values row by row
+
+}	dataset_header_t;
+
+#define CACHE_MAGIC			"PTCACHE"
+#define CACHE_VERSION		1
+// the preprocessing of the cached points: linear_normalize, then skyline_point.
+// Bump it whenever either of them changes its result, so that existing caches are recomputed.
+#define CACHE_PREPROCESS	1
+
+// header of the preprocessed dataset cache, the normalized skyline of a dataset.
+// The sections are laid out as in the binary dataset format, with coord holding normalized values.
+typedef struct cache_header
+{
+	char		magic[8];				// CACHE_MAGIC
+	uint32_t	version;				// CACHE_VERSION
+	uint32_t	preprocess;				// CACHE_PREPROCESS
+	uint64_t	source_hash;			// 64-bit FNV-1a hash of the content of the dataset file
+	uint64_t	source_size;			// size of the dataset file in bytes
+	uint32_t	numberOfSourcePoints;	// points of the dataset
+	uint32_t	numberOfPoints;			// points of the skyline
+	uint32_t	dim;
+	uint32_t	reserved;
+
+	uint64_t	min_offset;				// dim doubles, the minimum raw value of each dimension
+	uint64_t	max_offset;				// dim doubles, the maximum raw value of each dimension
+	uint64_t	id_offset;				// numberOfPoints int32 ids
+	uint64_t	coord_offset;			// numberOfPoints * dim doubles, the normalized values row by row
+
+}	cache_header_t;
 
 
 // read points from the input file
@@ -15,6 +65,25 @@
 // compute the skyline set
 // point_set_t* skyline_point(point_set_t *p);
 
+// check whether the file is in the binary dataset format
+bool is_binary_dataset(char* input);
+
+// map a dataset in the binary format into memory; NULL if the file is missing or malformed
+point_set_t* load_points_binary(char* input);
+
+// map a dataset in the binary format into memory, exiting if the file is missing or malformed
+point_set_t* read_points_binary(char* input);
+
+// write a point set in the binary dataset format, normalizing it first if it has not been
+void write_points_binary(point_set_t* point_set, char* output);
+
+// read a dataset, normalize it and compute its skyline, through the cache file of the dataset;
+// NULL if the dataset is missing or malformed
+point_set_t* load_skyline(char* input, int* numberOfSourcePoints);
+
+// as load_skyline, exiting if the dataset is missing or malformed
+point_set_t* read_skyline(char* input, int* numberOfSourcePoints);
+
 // prepare the file for computing the convex hull (the candidate utility range R) via half space interaction
 void write_hyperplanes(vector<hyperplane_t*> utility_hyperplane, point_t* feasible_pt, char* filename);
 
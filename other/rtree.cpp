@@ -1,4 +1,5 @@
 #include "rtree.h"
+#include <algorithm>
 
 void q_swap(int *sorted_index, double *value, int i, int j)
 {
@@ -1228,7 +1229,7 @@ node_type* contructRtree(point_set_t* C, rtree_info *aInfo)
 		}
 	}
 
-	build_tree(&root, data, no_data, aInfo);
+	bulk_load_tree(&root, data, no_data, aInfo);
 
 	return root;
 }
@@ -1250,7 +1251,264 @@ node_type* contructRtree(point_set_t* P, std::vector<int> C_idx, rtree_info *aIn
 		}
 	}
 
-	build_tree(&root, data, no_data, aInfo);
+	bulk_load_tree(&root, data, no_data, aInfo);
 
 	return root;
-}
\ No newline at end of file
+}
+
+// remove the entry from its parent, keeping the parent's entries packed at the front of ptr
+static void remove_entry(node_type *parent, node_type *entry, rtree_info *aInfo)
+{
+	int i, stop = aInfo->M - parent->vacancy;
+
+	for (i = 0; i < stop; i++) {
+		if (parent->ptr[i] == entry)
+			break;
+	}
+	for (; i < stop - 1; i++)
+		parent->ptr[i] = parent->ptr[i + 1];
+	parent->ptr[stop - 1] = NULL;
+	parent->vacancy++;
+}
+
+// recompute the MBR of the node from its entries
+static void recompute_MBR(node_type *node, rtree_info *aInfo)
+{
+	int i, j, stop = aInfo->M - node->vacancy;
+
+	if (stop == 0) {
+		for (i = 0; i < aInfo->dim; i++) {
+			node->b[i] = (R_TYPE)(-1 * INT_MAX);
+			node->a[i] = (R_TYPE)(INT_MAX);
+		}
+		return;
+	}
+
+	for (i = 0; i < aInfo->dim; i++) {
+		node->a[i] = node->ptr[0]->a[i];
+		node->b[i] = node->ptr[0]->b[i];
+	}
+	for (j = 1; j < stop; j++)
+		cal_MBR_node_node(node->a, node->b, node, node->ptr[j], aInfo);
+}
+
+// collect the data entries below the node and free its internal nodes
+static void collect_orphans(node_type *node, std::vector<node_type*>& orphans, rtree_info *aInfo)
+{
+	if (node->attribute == LEAF) {
+		orphans.push_back(node);
+		return;
+	}
+
+	int i, stop = aInfo->M - node->vacancy;
+	for (i = 0; i < stop; i++)
+		collect_orphans(node->ptr[i], orphans, aInfo);
+	tree_node_deallocate(node);
+}
+
+// insert an existing data entry again, as in insert_node
+static void reinsert_entry(node_type *root, node_type *data_node, rtree_info *aInfo)
+{
+	node_type *node_found = root;
+	int level_found;
+
+	aInfo->extra_level = 0;
+	level_found = choose_leaf(&node_found, root, 0, data_node, aInfo);
+
+	data_node->parent = node_found;
+	if (node_found->vacancy != 0) {
+		node_found->ptr[aInfo->M - node_found->vacancy] = data_node;
+		node_found->vacancy--;
+		adjust_MBR(data_node, aInfo);
+	}
+	else {
+		overflow(node_found, level_found, level_found + 1, data_node, root, aInfo);
+	}
+}
+
+void delete_node(node_type *root, node_type *leaf, rtree_info *aInfo)
+{
+	node_type *node, *parent;
+	std::vector<node_type*> orphans;
+	int i, stop;
+
+	/*******/
+	/* D1 */
+	/*******/
+
+	/* remove the entry from its node */
+
+	node = leaf->parent;
+	remove_entry(node, leaf, aInfo);
+	tree_node_deallocate(leaf);
+
+	/*******/
+	/* CT */
+	/*******/
+
+	/*************************************************************/
+	/* Condense tree: going up to the root, an under-full node   */
+	/* is removed from its parent and its data entries are kept  */
+	/* for reinsertion; the other nodes get their MBR tightened   */
+	/*************************************************************/
+
+	while (node->attribute != ROOT) {
+
+		parent = node->parent;
+
+		if (aInfo->M - node->vacancy < aInfo->m) {
+			remove_entry(parent, node, aInfo);
+			collect_orphans(node, orphans, aInfo);
+		}
+		else {
+			recompute_MBR(node, aInfo);
+		}
+
+		node = parent;
+	}
+	recompute_MBR(root, aInfo);
+
+	/* shorten the tree while the root has a single internal child */
+
+	while (aInfo->M - root->vacancy == 1 && root->ptr[0]->attribute != LEAF) {
+		node = root->ptr[0];
+		stop = aInfo->M - node->vacancy;
+		for (i = 0; i < aInfo->M; i++) {
+			root->ptr[i] = i < stop ? node->ptr[i] : NULL;
+			if (i < stop)
+				root->ptr[i]->parent = root;
+		}
+		root->vacancy = node->vacancy;
+		tree_node_deallocate(node);
+	}
+
+	/* reinsert the orphaned data entries */
+
+	for (i = 0; i < (int)orphans.size(); i++)
+		reinsert_entry(root, orphans[i], aInfo);
+
+	return;
+
+} /* delete_node */
+
+void collect_leaves(node_type *node, std::vector<node_type*>& leaves, rtree_info *aInfo)
+{
+	if (node->attribute == LEAF) {
+		leaves.push_back(node);
+		return;
+	}
+
+	int i, stop = aInfo->M - node->vacancy;
+	for (i = 0; i < stop; i++)
+		collect_leaves(node->ptr[i], leaves, aInfo);
+}
+
+void release_rtree(node_type *root, rtree_info *aInfo)
+{
+	if (root->attribute != LEAF) {
+		int i, stop = aInfo->M - root->vacancy;
+		for (i = 0; i < stop; i++)
+			release_rtree(root->ptr[i], aInfo);
+	}
+	tree_node_deallocate(root);
+}
+
+// Sort-Tile-Recursive order of entries[begin, end) from the given axis on: sort by the centers along
+// the axis, cut the entries into slabs of whole nodes and order each slab along the next axis
+static void str_order(node_type **entries, int begin, int end, int axis, rtree_info *aInfo)
+{
+	int count = end - begin, pages, slabs, slab_size, s;
+
+	std::sort(entries + begin, entries + end, [axis](const node_type *l, const node_type *r) {
+		return l->a[axis] + l->b[axis] < r->a[axis] + r->b[axis];
+	});
+	if (axis == aInfo->dim - 1 || count <= aInfo->M)
+		return;
+
+	pages = (count + aInfo->M - 1) / aInfo->M;
+	slabs = (int)ceil(pow((double)pages, 1.0 / (aInfo->dim - axis)));
+	slab_size = (pages + slabs - 1) / slabs * aInfo->M;
+	for (s = begin; s < end; s += slab_size)
+		str_order(entries, s, std::min(s + slab_size, end), axis + 1, aInfo);
+}
+
+// pack the entries of one level into full nodes, returning the nodes of the level above
+static std::vector<node_type*> pack_level(std::vector<node_type*>& entries, rtree_info *aInfo)
+{
+	int count = entries.size(), nodes = (count + aInfo->M - 1) / aInfo->M;
+	int i, k, size, start = 0;
+	std::vector<node_type*> parents(nodes);
+	node_type *node;
+
+	str_order(entries.data(), 0, count, 0, aInfo);
+
+	for (k = 0; k < nodes; k++) {
+
+		// the last two nodes share the rest, so that none is under-full for delete_node
+		size = aInfo->M;
+		if (k == nodes - 2)
+			size = (count - start + 1) / 2;
+		else if (k == nodes - 1)
+			size = count - start;
+
+		tree_node_allocate(&node, aInfo);
+		node->id = NO_ID;
+		node->attribute = NODE;
+		node->vacancy = aInfo->M - size;
+		for (i = 0; i < aInfo->M; i++) {
+			node->ptr[i] = i < size ? entries[start + i] : NULL;
+			if (i < size)
+				node->ptr[i]->parent = node;
+		}
+		recompute_MBR(node, aInfo);
+
+		parents[k] = node;
+		start += size;
+	}
+
+	return parents;
+}
+
+void bulk_load_tree(node_type **root, R_TYPE **data, int no_data, rtree_info *aInfo)
+{
+	std::vector<node_type*> entries(no_data);
+	int i, j;
+
+	/* make the leaf entries */
+
+	for (i = 0; i < no_data; i++) {
+		tree_node_allocate(&entries[i], aInfo);
+		for (j = 0; j < aInfo->dim; j++) {
+			entries[i]->a[j] = data[i][j];
+			entries[i]->b[j] = data[i][j];
+		}
+		entries[i]->id = i;		// i is the seq id.
+		entries[i]->attribute = LEAF;
+		entries[i]->vacancy = aInfo->M;
+		for (j = 0; j < aInfo->M; j++)
+			entries[i]->ptr[j] = NULL;
+
+		free(data[i]);
+	}
+	free(data);
+
+	/* pack level by level until the entries fit in the root */
+
+	while ((int)entries.size() > aInfo->M)
+		entries = pack_level(entries, aInfo);
+
+	tree_node_allocate(root, aInfo);
+	(*root)->id = -3;		//NO_ID
+	(*root)->attribute = ROOT;
+	(*root)->vacancy = aInfo->M - entries.size();
+	(*root)->parent = NULL;
+	for (j = 0; j < aInfo->M; j++) {
+		(*root)->ptr[j] = j < (int)entries.size() ? entries[j] : NULL;
+		if (j < (int)entries.size())
+			entries[j]->parent = *root;
+	}
+	recompute_MBR(*root, aInfo);
+
+	aInfo->extra_level = 0;
+
+} /* bulk_load_tree */
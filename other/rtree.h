@@ -19,9 +19,24 @@
 void overflow(node_type *over_node, int over_level, int old_level, node_type
 	*extra_node, node_type *root, rtree_info *aInfo);
 
+// build the tree over data[0..no_data) by repeated insertion (frees data)
+void build_tree(node_type **root, R_TYPE **data, int no_data, rtree_info *aInfo);
+
+// build the tree over data[0..no_data) with Sort-Tile-Recursive packing (frees data)
+void bulk_load_tree(node_type **root, R_TYPE **data, int no_data, rtree_info *aInfo);
+
 node_type* contructRtree(point_set_t* C, rtree_info *aInfo);
 
 node_type* contructRtree(point_set_t* P, std::vector<int> C_idx, rtree_info *aInfo);
 
+// delete the leaf entry of a data point, condensing the tree (the entries of under-full nodes are reinserted)
+void delete_node(node_type *root, node_type *leaf, rtree_info *aInfo);
+
+// collect the leaf entries (the data points) below the node
+void collect_leaves(node_type *node, std::vector<node_type*>& leaves, rtree_info *aInfo);
+
+// free all the nodes of the tree
+void release_rtree(node_type *root, rtree_info *aInfo);
+
 #endif 
 
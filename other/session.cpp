@@ -0,0 +1,140 @@
+#include "session.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+// the session running on this thread
+static thread_local session_t* running = NULL;
+
+// the size of a session stack, read once
+static size_t stack_bytes()
+{
+	static size_t bytes = 0;
+	if (bytes == 0)
+	{
+		const char* env = getenv("SESSION_STACK_BYTES");
+		bytes = (env != NULL && atoll(env) > 0) ? (size_t)atoll(env) : SESSION_STACK_BYTES;
+	}
+	return bytes;
+}
+
+// entry point of a session stack; returning resumes the caller of next_question through uc_link
+static void session_main()
+{
+	session_t* ss = running;
+	ss->body();
+	ss->finished = true;
+}
+
+session_t* alloc_session(std::function<void()> body)
+{
+	session_t* ss = new session_t;
+	ss->body = body;
+	ss->phase = 0;
+	ss->asked = false;
+	ss->answered = false;
+	ss->answer = 0;
+	ss->finished = false;
+
+	// the stack is only reserved: pages are committed as the algorithm touches them, and the lowest one
+	// is a guard page turning an overflow into a fault
+	long page = sysconf(_SC_PAGESIZE);
+	ss->stack_bytes = (stack_bytes() + page - 1) / page * page + page;
+	ss->stack = (char*)mmap(NULL, ss->stack_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+	if (ss->stack == MAP_FAILED)
+	{
+		printf("Cannot allocate a session stack of %zu bytes\n", ss->stack_bytes);
+		exit(1);
+	}
+	mprotect(ss->stack, page, PROT_NONE);
+
+	getcontext(&ss->ctx);
+	ss->ctx.uc_stack.ss_sp = ss->stack;
+	ss->ctx.uc_stack.ss_size = ss->stack_bytes;
+	ss->ctx.uc_link = &ss->caller;
+	makecontext(&ss->ctx, session_main, 0);
+	return ss;
+}
+
+const session_question_t* next_question(session_t* ss)
+{
+	if (ss->asked && !ss->answered)
+		return &ss->question;
+	if (ss->finished)
+		return NULL;
+
+	session_t* outer = running;
+	running = ss;
+	swapcontext(&ss->caller, &ss->ctx);
+	running = outer;
+
+	return ss->finished ? NULL : &ss->question;
+}
+
+bool submit_answer(session_t* ss, int answer)
+{
+	if (!ss->asked || ss->answered)
+		return false;
+	if (answer != -99 && (answer < 0 || answer > (int)ss->question.ids.size()))
+		return false;
+
+	ss->answer = answer;
+	ss->answered = true;
+	return true;
+}
+
+bool session_finished(session_t* ss)
+{
+	return ss->finished;
+}
+
+void release_session(session_t* ss)
+{
+	while (next_question(ss) != NULL)
+		submit_answer(ss, -99);
+
+	munmap(ss->stack, ss->stack_bytes);
+	delete ss;
+}
+
+session_t* current_session()
+{
+	return running;
+}
+
+const char* session_name()
+{
+	if (running != NULL && !running->name.empty())
+		return running->name.c_str();
+	return getenv("SESSION_ID");
+}
+
+void session_phase(int phase)
+{
+	if (running != NULL)
+		running->phase = phase;
+}
+
+void session_post(int phase, const std::set<int>& dimensions, const std::vector<int>& ids, const std::vector<double>& coords)
+{
+	session_t* ss = running;
+	ss->question.phase = phase;
+	ss->question.dimensions = dimensions;
+	ss->question.ids = ids;
+	ss->question.coords = coords;
+	ss->asked = true;
+	ss->answered = false;
+}
+
+int session_wait()
+{
+	session_t* ss = running;
+	if (!ss->answered)
+		swapcontext(&ss->ctx, &ss->caller);
+
+	ss->asked = false;
+	ss->answered = false;
+	return ss->answer;
+}
@@ -0,0 +1,85 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <functional>
+#include <set>
+#include <string>
+#include <vector>
+#include <ucontext.h>
+
+/*
+ * A session runs an interactive algorithm (interactive_highdim, max_utility) as a coroutine on a stack of its own.
+ * Where the algorithm would print a question and block in scanf, it suspends instead: next_question resumes it
+ * until it asks its next question, and submit_answer hands over the user's choice. The state of the algorithm
+ * (the phase 1/2 dimension sets, C_idx, ext_vec, the frame, ...) stays on the session stack between the calls,
+ * so one thread can serve any number of sessions. A session must always be resumed on the same thread.
+ */
+
+// default size of a session stack; the SESSION_STACK_BYTES environment variable overrides it
+#define SESSION_STACK_BYTES (8 << 20)
+
+// a question asked by the algorithm
+typedef struct session_question
+{
+	int					phase;		// 1 and 2: the dimension questions of interactive_highdim, 3: the questions of max_utility
+	std::set<int>		dimensions;	// the dimensions shown
+	std::vector<int>	ids;		// the ids of the options; raw_coord gives their raw values
+	std::vector<double>	coords;		// the normalized coordinates of the options on the dimensions, one row per option
+
+}	session_question_t;
+
+typedef struct session
+{
+	std::function<void()>	body;		// the algorithm, run on the session stack
+	ucontext_t				ctx;
+	ucontext_t				caller;		// the caller of next_question while the session runs
+	char*					stack;
+	size_t					stack_bytes;
+	std::string				name;		// the id of the session file (DATA_DIR/sessions/<name>.json); empty for SESSION_ID
+
+	int						phase;
+	session_question_t		question;
+	bool					asked;		// question waits for an answer
+	bool					answered;
+	int						answer;
+	bool					finished;
+
+}	session_t;
+
+// create a session running body; nothing runs before the first next_question
+session_t* alloc_session(std::function<void()> body);
+
+// run the session until its next question and return it, or NULL once the algorithm has finished.
+// Until the question is answered, further calls return it again without running the algorithm.
+const session_question_t* next_question(session_t* ss);
+
+// answer the pending question as a user would type it: 0 for not interested, i for option i, -99 to stop.
+// Returns false (and keeps the question pending) if no question is pending or the answer is out of range.
+bool submit_answer(session_t* ss, int answer);
+
+// check whether the algorithm has finished
+bool session_finished(session_t* ss);
+
+// release a session; an unfinished one is first stopped by answering -99 until the algorithm returns
+void release_session(session_t* ss);
+
+/*
+ * Used by the algorithms to ask through the session they run in.
+ */
+
+// the session running on this thread, NULL outside of a session
+session_t* current_session();
+
+// the id of the session file of the current session: its name, else the SESSION_ID environment variable (NULL if unset)
+const char* session_name();
+
+// record the phase of the following questions of the current session, if any
+void session_phase(int phase);
+
+// post a question of the current session; it is returned by next_question once the session waits for the answer
+void session_post(int phase, const std::set<int>& dimensions, const std::vector<int>& ids, const std::vector<double>& coords);
+
+// suspend the current session until the posted question is answered, and return the answer
+int session_wait();
+
+#endif
@@ -0,0 +1,558 @@
+#include "simplex.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+#define SIMPLEX_PIVOT_TOL	1e-9	// smallest pivot element
+#define SIMPLEX_OPT_TOL		1e-9	// reduced costs above -SIMPLEX_OPT_TOL are optimal
+#define SIMPLEX_FEAS_TOL	1e-7	// largest infeasibility accepted in the solution
+#define SIMPLEX_DRIVE_TOL	1e-7	// smallest pivot element taking an artificial out of the basis
+#define SIMPLEX_BLAND_AFTER	50		// degenerate pivots in a row before switching to Bland's rule
+
+void init_dense_lp(dense_lp_t& lp, int rows, int cols, bool maximize)
+{
+	lp.rows = rows;
+	lp.cols = cols;
+	lp.maximize = maximize;
+	lp.A.assign((size_t)rows * cols, 0);
+	lp.b.assign(rows, 0);
+	lp.c.assign(cols, 0);
+	lp.row_type.assign(rows, SIMPLEX_LE);
+	lp.col_type.assign(cols, SIMPLEX_LO);
+	lp.ub.assign(cols, 0);
+	lp.obj = 0;
+	lp.x.assign(cols, 0);
+	lp.dual.assign(rows, 0);
+}
+
+// tableau width for rows x cols: at most two variables per column, a slack and an artificial per row, and the right-hand side
+static long long tableau_width(int rows, int cols)
+{
+	return 2LL * cols + 2LL * rows + 1;
+}
+
+bool fits_dense_lp(int rows, int cols)
+{
+	return (rows + 1LL) * tableau_width(rows, cols) <= SIMPLEX_MAX_CELLS;
+}
+
+/*
+ * The tableau: rows 0..m-1 hold the constraints and row m the reduced costs of the current objective
+ * (to be maximized), with the right-hand side in the last column. The basic variable of row i is basis[i].
+ */
+typedef struct tableau
+{
+	int				m;
+	int				width;	// number of variables + 1
+	double*			T;
+	vector<int>		basis;
+
+	double* row(int i) { return T + (size_t)i * width; }
+
+}	tableau_t;
+
+static void pivot(tableau_t& t, int r, int q)
+{
+	double* pr = t.row(r);
+	double inv = 1.0 / pr[q];
+	for (int j = 0; j < t.width; j++)
+		pr[j] *= inv;
+	pr[q] = 1.0;
+
+	for (int i = 0; i <= t.m; i++)
+	{
+		if (i == r)
+			continue;
+		double* pi = t.row(i);
+		double f = pi[q];
+		if (f == 0)
+			continue;
+		for (int j = 0; j < t.width; j++)
+			pi[j] -= f * pr[j];
+		pi[q] = 0;
+	}
+	t.basis[r] = q;
+}
+
+/*
+ * Primal simplex on the tableau, letting only the variables below `enter` into the basis.
+ * Dantzig's rule is used until the pivots keep being degenerate, then Bland's rule, which cannot cycle.
+ */
+static int run_simplex(tableau_t& t, int enter)
+{
+	int rhs = t.width - 1;
+	int max_iter = 50 * (t.m + t.width);
+	int degenerate = 0;
+	double* obj = t.row(t.m);
+
+	for (int iter = 0; iter < max_iter; iter++)
+	{
+		bool bland = degenerate >= SIMPLEX_BLAND_AFTER;
+		int q = -1;
+		double best = -SIMPLEX_OPT_TOL;
+		for (int j = 0; j < enter; j++)
+		{
+			if (obj[j] < best)
+			{
+				q = j;
+				if (bland)
+					break;
+				best = obj[j];
+			}
+		}
+		if (q == -1)
+			return SIMPLEX_OPT;
+
+		// Harris' ratio test: among the rows within the tolerance of the minimum ratio, take the largest
+		// pivot, which keeps the tableau accurate; Bland's rule needs the exact minimum with the smallest index
+		double bound = INFINITY;
+		for (int i = 0; i < t.m && !bland; i++)
+		{
+			double a = t.row(i)[q];
+			if (a > SIMPLEX_PIVOT_TOL)
+				bound = min(bound, (max(t.row(i)[rhs], 0.0) + SIMPLEX_FEAS_TOL) / a);
+		}
+		int r = -1;
+		double ratio = 0;
+		for (int i = 0; i < t.m; i++)
+		{
+			double a = t.row(i)[q];
+			if (a <= SIMPLEX_PIVOT_TOL)
+				continue;
+			double v = max(t.row(i)[rhs], 0.0) / a;
+			if (bland ? r == -1 || v < ratio || (v == ratio && t.basis[i] < t.basis[r])
+				: v <= bound && (r == -1 || a > t.row(r)[q]))
+			{
+				r = i;
+				ratio = v;
+			}
+		}
+		if (r == -1)
+			return SIMPLEX_UNBND;
+
+		degenerate = ratio == 0 ? degenerate + 1 : 0;
+		pivot(t, r, q);
+	}
+	return SIMPLEX_FAIL;
+}
+
+/*
+ * Dual simplex on a tableau whose reduced costs are optimal, letting only the variables below `enter` into
+ * the basis: the most infeasible row leaves, and the entering variable keeps the reduced costs optimal.
+ * Rows below -tol are infeasible.
+ */
+static int run_dual_simplex(tableau_t& t, int enter, double tol)
+{
+	int rhs = t.width - 1;
+	int max_iter = 50 * (t.m + t.width);
+	double* obj = t.row(t.m);
+
+	for (int iter = 0; iter < max_iter; iter++)
+	{
+		int r = -1;
+		double worst = -tol;
+		for (int i = 0; i < t.m; i++)
+		{
+			if (t.row(i)[rhs] < worst)
+			{
+				r = i;
+				worst = t.row(i)[rhs];
+			}
+		}
+		if (r == -1)
+			return SIMPLEX_OPT;
+
+		// among the variables with the smallest ratio, take the largest pivot
+		double* pr = t.row(r);
+		int q = -1;
+		double ratio = INFINITY;
+		for (int j = 0; j < enter; j++)
+		{
+			double a = pr[j];
+			if (a >= -SIMPLEX_PIVOT_TOL)
+				continue;
+			double v = max(obj[j], 0.0) / -a;
+			if (q == -1 || v < ratio - SIMPLEX_OPT_TOL || (v <= ratio + SIMPLEX_OPT_TOL && a < pr[q]))
+			{
+				q = j;
+				ratio = min(ratio, v);
+			}
+		}
+		if (q == -1)
+			return SIMPLEX_INFEAS;
+
+		pivot(t, r, q);
+	}
+	return SIMPLEX_FAIL;
+}
+
+/*
+ * Read x, obj and dual of lp from the optimal tableau t, returning false if the solution is not feasible
+ * enough to trust. var: the first variable of each column, unit: the unit column of each row and unit_sign
+ * its sign, constant: the objective of the upper bounded columns at their bound (as a maximization),
+ * scale: the largest right-hand side magnitude.
+ */
+static bool read_solution(dense_lp_t& lp, tableau_t& t, const vector<int>& var, const vector<int>& unit,
+	const vector<double>& unit_sign, double constant, double scale)
+{
+	int m = lp.rows, n = lp.cols;
+	int rhs = t.width - 1;
+	double dir = lp.maximize ? 1 : -1;
+
+	static thread_local vector<double> y;
+	y.assign(t.width - 1, 0);
+	for (int i = 0; i < m; i++)
+	{
+		double v = t.row(i)[rhs];
+		if (v < -SIMPLEX_FEAS_TOL * scale)
+			return false;
+		y[t.basis[i]] = max(v, 0.0);
+	}
+	for (int j = 0; j < n; j++)
+	{
+		if (lp.col_type[j] == SIMPLEX_FR)
+			lp.x[j] = y[var[j]] - y[var[j] + 1];
+		else if (lp.col_type[j] == SIMPLEX_UP)
+			lp.x[j] = lp.ub[j] - y[var[j]];
+		else
+			lp.x[j] = y[var[j]];
+	}
+	for (int i = 0; i < m; i++)
+	{
+		double ax = 0, size = scale;
+		for (int j = 0; j < n; j++)
+		{
+			ax += lp.A[(size_t)i * n + j] * lp.x[j];
+			size = max(size, fabs(lp.A[(size_t)i * n + j] * lp.x[j]));
+		}
+		double violation = lp.row_type[i] == SIMPLEX_EQ ? fabs(ax - lp.b[i]) : ax - lp.b[i];
+		if (violation > SIMPLEX_FEAS_TOL * size)
+			return false;
+	}
+
+	lp.obj = dir * (t.row(m)[rhs] + constant);
+	for (int i = 0; i < m; i++)
+		lp.dual[i] = dir * unit_sign[i] * t.row(m)[unit[i]];
+	return true;
+}
+
+/*
+ * Keep the optimal tableau t of the LP of ilp for a warm start, without its artificial columns. Only LPs
+ * of SIMPLEX_LE rows whose artificials all left the basis are kept, so that every row has its slack.
+ */
+static void keep_tableau(incremental_lp_t& ilp, tableau_t& t, const vector<int>& var, int vars, double constant, double scale)
+{
+	int m = t.m;
+	int first_art = vars + m;
+	for (int i = 0; i < m; i++)
+		if (ilp.lp.row_type[i] != SIMPLEX_LE || t.basis[i] >= first_art)
+			return;
+
+	int width = first_art + 1;
+	ilp.T.assign((size_t)(m + 1) * width, 0);
+	for (int i = 0; i <= m; i++)
+	{
+		double* from = t.row(i);
+		double* to = &ilp.T[(size_t)i * width];
+		copy(from, from + first_art, to);
+		to[width - 1] = from[t.width - 1];
+	}
+	ilp.basis = t.basis;
+	ilp.var = var;
+	ilp.vars = vars;
+	ilp.width = width;
+	ilp.constant = constant;
+	ilp.scale = scale;
+	ilp.warm = true;
+}
+
+// the two-phase simplex from scratch, keeping the optimal tableau in keep if it is not NULL
+static int solve_cold(dense_lp_t& lp, incremental_lp_t* keep)
+{
+	int m = lp.rows, n = lp.cols;
+	if (!fits_dense_lp(m, n))
+		return SIMPLEX_FAIL;
+
+	// map the columns to variables >= 0: x = y (LO), x = y+ - y- (FR), x = ub - y (UP)
+	vector<int> var(n);
+	int vars = 0;
+	for (int j = 0; j < n; j++)
+	{
+		var[j] = vars;
+		vars += lp.col_type[j] == SIMPLEX_FR ? 2 : 1;
+	}
+
+	// right-hand sides after substituting the upper bounded columns, and row signs making them >= 0
+	vector<double> b(lp.b);
+	for (int i = 0; i < m; i++)
+		for (int j = 0; j < n; j++)
+			if (lp.col_type[j] == SIMPLEX_UP)
+				b[i] -= lp.A[(size_t)i * n + j] * lp.ub[j];
+	vector<double> sign(m);
+	int slacks = 0, artificials = 0;
+	for (int i = 0; i < m; i++)
+	{
+		sign[i] = b[i] < 0 ? -1 : 1;
+		if (lp.row_type[i] == SIMPLEX_LE)
+			slacks++;
+		if (lp.row_type[i] == SIMPLEX_EQ || sign[i] < 0)
+			artificials++;
+	}
+	int first_slack = vars, first_art = vars + slacks;
+
+	static thread_local vector<double> cells;
+	tableau_t t;
+	t.m = m;
+	t.width = first_art + artificials + 1;
+	cells.assign((size_t)(m + 1) * t.width, 0);
+	t.T = cells.data();
+	t.basis.assign(m, -1);
+	int rhs = t.width - 1;
+
+	// unit column of each row (the slack of a <= row, the artificial of a = row) and its sign, for the duals
+	vector<int> unit(m);
+	vector<double> unit_sign(m);
+	int slack = first_slack, art = first_art;
+	for (int i = 0; i < m; i++)
+	{
+		double* row = t.row(i);
+		for (int j = 0; j < n; j++)
+		{
+			double a = sign[i] * lp.A[(size_t)i * n + j];
+			if (lp.col_type[j] == SIMPLEX_UP)
+				a = -a;
+			row[var[j]] = a;
+			if (lp.col_type[j] == SIMPLEX_FR)
+				row[var[j] + 1] = -a;
+		}
+		row[rhs] = sign[i] * b[i];
+
+		if (lp.row_type[i] == SIMPLEX_LE)
+		{
+			row[slack] = sign[i];
+			unit[i] = slack;
+			unit_sign[i] = 1;
+			if (sign[i] > 0)
+				t.basis[i] = slack;
+			slack++;
+		}
+		if (t.basis[i] == -1)
+		{
+			row[art] = 1;
+			if (lp.row_type[i] == SIMPLEX_EQ)
+			{
+				unit[i] = art;
+				unit_sign[i] = sign[i];
+			}
+			t.basis[i] = art++;
+		}
+	}
+
+	// phase 1: maximize minus the sum of the artificials
+	double* obj = t.row(m);
+	for (int i = 0; i < m; i++)
+	{
+		if (t.basis[i] < first_art)
+			continue;
+		double* row = t.row(i);
+		for (int j = 0; j < t.width; j++)
+			obj[j] -= row[j];
+		obj[t.basis[i]] = 0;
+	}
+	int status = run_simplex(t, first_art);
+	if (status != SIMPLEX_OPT)
+		return SIMPLEX_FAIL;
+	double scale = 1;
+	for (int i = 0; i < m; i++)
+		scale = max(scale, fabs(b[i]));
+	if (obj[rhs] < -SIMPLEX_FEAS_TOL * scale)
+		return SIMPLEX_INFEAS;
+
+	// drive the artificials left at zero out of the basis; a row where that fails is redundant
+	for (int i = 0; i < m; i++)
+	{
+		if (t.basis[i] < first_art)
+			continue;
+		double* row = t.row(i);
+		int q = -1;
+		for (int j = 0; j < first_art; j++)
+			if (fabs(row[j]) > SIMPLEX_DRIVE_TOL && (q == -1 || fabs(row[j]) > fabs(row[q])))
+				q = j;
+		if (q != -1)
+			pivot(t, i, q);
+	}
+
+	// phase 2: the objective in the variables, as a maximization
+	vector<double> cost(t.width, 0);
+	double constant = 0;
+	double dir = lp.maximize ? 1 : -1;
+	for (int j = 0; j < n; j++)
+	{
+		double cj = dir * lp.c[j];
+		if (lp.col_type[j] == SIMPLEX_UP)
+		{
+			constant += cj * lp.ub[j];
+			cj = -cj;
+		}
+		cost[var[j]] = cj;
+		if (lp.col_type[j] == SIMPLEX_FR)
+			cost[var[j] + 1] = -cj;
+	}
+	for (int j = 0; j < t.width; j++)
+		obj[j] = -cost[j];
+	obj[rhs] = 0;
+	for (int i = 0; i < m; i++)
+	{
+		double cb = cost[t.basis[i]];
+		if (cb == 0)
+			continue;
+		double* row = t.row(i);
+		for (int j = 0; j < t.width; j++)
+			obj[j] += cb * row[j];
+	}
+	status = run_simplex(t, first_art);
+	if (status != SIMPLEX_OPT)
+		return status;
+
+	// read the solution, rejecting it if it is not feasible enough to trust
+	if (!read_solution(lp, t, var, unit, unit_sign, constant, scale))
+		return SIMPLEX_FAIL;
+	if (keep != NULL)
+		keep_tableau(*keep, t, var, vars, constant, scale);
+	return SIMPLEX_OPT;
+}
+
+int solve_dense_lp(dense_lp_t& lp)
+{
+	return solve_cold(lp, NULL);
+}
+
+void init_incremental_lp(incremental_lp_t& ilp, int cols, bool maximize, int rows)
+{
+	init_dense_lp(ilp.lp, 0, cols, maximize);
+	ilp.lp.A.reserve((size_t)rows * cols);
+	ilp.lp.b.reserve(rows);
+	ilp.lp.row_type.reserve(rows);
+	ilp.lp.dual.reserve(rows);
+	ilp.warm = false;
+	ilp.T.clear();
+	ilp.basis.clear();
+	ilp.warm_solves = 0;
+	ilp.cold_solves = 0;
+}
+
+void add_incremental_row(incremental_lp_t& ilp, const double* a, double b)
+{
+	dense_lp_t& lp = ilp.lp;
+	lp.A.insert(lp.A.end(), a, a + lp.cols);
+	lp.b.push_back(b);
+	lp.row_type.push_back(SIMPLEX_LE);
+	lp.dual.push_back(0);
+	lp.rows++;
+}
+
+/*
+ * Add the rows of lp not in the kept tableau yet, each with its slack basic, in one pass: the tableau is
+ * widened by their slacks before the right-hand side, and the basic variables are eliminated from them.
+ * The reduced costs stay optimal; only the new slacks may be negative.
+ */
+static void widen_tableau(incremental_lp_t& ilp)
+{
+	dense_lp_t& lp = ilp.lp;
+	int n = lp.cols;
+	int old_m = ilp.basis.size(), m = lp.rows;
+	int old_width = ilp.width, width = ilp.vars + m + 1;
+
+	static thread_local vector<double> T;
+	T.assign((size_t)(m + 1) * width, 0);
+	for (int i = 0; i <= old_m; i++)
+	{
+		const double* from = &ilp.T[(size_t)i * old_width];
+		double* to = &T[(size_t)(i < old_m ? i : m) * width];
+		copy(from, from + old_width - 1, to);
+		to[width - 1] = from[old_width - 1];
+	}
+
+	for (int r = old_m; r < m; r++)
+	{
+		double* row = &T[(size_t)r * width];
+		double rhs = lp.b[r];
+		for (int j = 0; j < n; j++)
+		{
+			double aj = lp.A[(size_t)r * n + j];
+			if (lp.col_type[j] == SIMPLEX_UP)
+			{
+				rhs -= aj * lp.ub[j];
+				aj = -aj;
+			}
+			row[ilp.var[j]] = aj;
+			if (lp.col_type[j] == SIMPLEX_FR)
+				row[ilp.var[j] + 1] = -aj;
+		}
+		row[ilp.vars + r] = 1;
+		row[width - 1] = rhs;
+		ilp.scale = max(ilp.scale, fabs(rhs));
+
+		for (int i = 0; i < old_m; i++)
+		{
+			double f = row[ilp.basis[i]];
+			if (f == 0)
+				continue;
+			const double* ri = &T[(size_t)i * width];
+			for (int j = 0; j < width; j++)
+				row[j] -= f * ri[j];
+			row[ilp.basis[i]] = 0;
+		}
+		ilp.basis.push_back(ilp.vars + r);
+	}
+
+	ilp.T.swap(T);
+	ilp.width = width;
+}
+
+int solve_incremental_lp(incremental_lp_t& ilp)
+{
+	dense_lp_t& lp = ilp.lp;
+	int m = lp.rows;
+	if (ilp.warm && fits_dense_lp(m, lp.cols))
+	{
+		if ((int)ilp.basis.size() < m)
+			widen_tableau(ilp);
+
+		tableau_t t;
+		t.m = m;
+		t.width = ilp.width;
+		t.T = ilp.T.data();
+		t.basis.swap(ilp.basis);
+
+		// the dual simplex restores feasibility, and the primal one cleans up reduced costs within the tolerance
+		int enter = t.width - 1;
+		int status = run_dual_simplex(t, enter, SIMPLEX_FEAS_TOL * ilp.scale);
+		if (status == SIMPLEX_OPT)
+			status = run_simplex(t, enter);
+
+		// the unit column of row i is its slack
+		bool read = false;
+		if (status == SIMPLEX_OPT)
+		{
+			static thread_local vector<int> unit;
+			static thread_local vector<double> unit_sign;
+			unit.resize(m);
+			unit_sign.assign(m, 1);
+			for (int i = 0; i < m; i++)
+				unit[i] = ilp.vars + i;
+			read = read_solution(lp, t, ilp.var, unit, unit_sign, ilp.constant, ilp.scale);
+		}
+		t.basis.swap(ilp.basis);
+		if (read)
+		{
+			ilp.warm_solves++;
+			return SIMPLEX_OPT;
+		}
+	}
+
+	ilp.warm = false;
+	ilp.cold_solves++;
+	return solve_cold(lp, &ilp);
+}
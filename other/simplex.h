@@ -0,0 +1,91 @@
+#ifndef SIMPLEX_H
+#define SIMPLEX_H
+
+#include <vector>
+
+// dense two-phase simplex for the small LPs of lp.cpp (a few dozen rows, about D + 1 columns)
+
+// largest tableau, in entries, solved densely; larger problems are left to GLPK
+#define SIMPLEX_MAX_CELLS 65536
+
+// row types
+#define SIMPLEX_LE	0	// a x <= b
+#define SIMPLEX_EQ	1	// a x = b
+
+// column types
+#define SIMPLEX_LO	0	// 0 <= x
+#define SIMPLEX_FR	1	// x free
+#define SIMPLEX_UP	2	// x <= ub
+
+// status of a solve
+#define SIMPLEX_OPT		0
+#define SIMPLEX_INFEAS	1
+#define SIMPLEX_UNBND	2
+#define SIMPLEX_FAIL	3	// too large or numerically unreliable: solve with GLPK instead
+
+/*
+ * optimize c x subject to A x (<= or =) b and the column bounds, with A stored row-major.
+ * After an optimal solve, x holds the column values and dual the row duals
+ * (the reduced cost of column j is c[j] - sum_i dual[i] * A[i][j], as in GLPK).
+ */
+typedef struct dense_lp
+{
+	int						rows;
+	int						cols;
+	bool					maximize;
+	std::vector<double>		A;
+	std::vector<double>		b;
+	std::vector<double>		c;
+	std::vector<int>		row_type;
+	std::vector<int>		col_type;
+	std::vector<double>		ub;
+
+	double					obj;
+	std::vector<double>		x;
+	std::vector<double>		dual;
+
+}	dense_lp_t;
+
+// set up an LP of the given size with A = 0, b = 0, c = 0, rows of type SIMPLEX_LE and columns of type SIMPLEX_LO
+void init_dense_lp(dense_lp_t& lp, int rows, int cols, bool maximize);
+
+// check whether the LP is small enough for the dense solver
+bool fits_dense_lp(int rows, int cols);
+
+// solve the LP, returning its status
+int solve_dense_lp(dense_lp_t& lp);
+
+/*
+ * An LP of SIMPLEX_LE rows that grows by rows. The tableau of an optimal solve is kept: a row added to it
+ * leaves the basis dual feasible, so the next solve starts from that basis with the dual simplex instead
+ * of solving from scratch. A solve that cannot start from a kept basis, or whose warm start fails, is
+ * solved from scratch as solve_dense_lp does. lp holds the LP and the solution of the last solve.
+ */
+typedef struct incremental_lp
+{
+	dense_lp_t				lp;
+
+	bool					warm;		// T holds an optimal tableau of lp
+	int						vars;		// tableau variables of the columns, followed by one slack per row
+	int						width;		// vars + rows + 1, the last column holding the right-hand side
+	std::vector<int>		var;		// first tableau variable of each column
+	std::vector<double>		T;			// rows 0..rows-1 the constraints, row rows the reduced costs
+	std::vector<int>		basis;
+	double					constant;	// objective of the upper bounded columns at their bound, as a maximization
+	double					scale;		// largest right-hand side magnitude, at least 1
+
+	long long				warm_solves;	// solves started from a kept basis
+	long long				cold_solves;	// solves from scratch
+
+}	incremental_lp_t;
+
+// set up an LP without rows, with c = 0 and columns of type SIMPLEX_LO, with room for rows rows
+void init_incremental_lp(incremental_lp_t& ilp, int cols, bool maximize, int rows);
+
+// add the row a x <= b, a holding one entry per column
+void add_incremental_row(incremental_lp_t& ilp, const double* a, double b);
+
+// solve the LP, from the basis of the last solve if there is one, returning its status
+int solve_incremental_lp(incremental_lp_t& ilp);
+
+#endif // SIMPLEX_H
@@ -0,0 +1,168 @@
+#include "skyline_cache.h"
+#include "data_utility.h"
+#include "operation.h"
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+
+using namespace std;
+
+// a cached subspace skyline: the indices of the skyline points in the base point set
+struct skyline_cache_entry
+{
+	string		key;
+	vector<int>	skyline;
+};
+
+static mutex cache_mutex;
+static list<skyline_cache_entry> cache_lru;	// most recently used first
+static unordered_map<string, list<skyline_cache_entry>::iterator> cache_index;
+static skyline_cache_stats_t cache_stats = {0, 0, 0, 0, 0};
+static size_t cache_capacity = 0;
+
+// approximate memory held by an entry
+static size_t entry_bytes(const skyline_cache_entry& e)
+{
+	return sizeof(skyline_cache_entry) + 2 * e.key.size() + e.skyline.size() * sizeof(int) + 4 * sizeof(void*);
+}
+
+// 64-bit FNV-1a
+static uint64_t fnv1a(uint64_t h, const void* data, size_t len)
+{
+	const unsigned char* p = (const unsigned char*)data;
+	for (size_t i = 0; i < len; i++)
+	{
+		h ^= p[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+// fingerprint of the ids and coordinates of a point set, computed on its first projection and kept in it,
+// as the point sets that are projected (the skylines of the sessions) are not modified afterwards
+static uint64_t fingerprint(point_set_t* point_set)
+{
+	if (point_set->fingerprint != 0)
+		return point_set->fingerprint;
+
+	uint64_t h = 14695981039346656037ULL;
+	int n = point_set->numberOfPoints;
+	h = fnv1a(h, &n, sizeof(n));
+	for (int i = 0; i < n; i++)
+	{
+		point_t* p = point_set->points[i];
+		h = fnv1a(h, &p->id, sizeof(p->id));
+		h = fnv1a(h, &p->dim, sizeof(p->dim));
+		h = fnv1a(h, p->coord, p->dim * sizeof(COORD_TYPE));
+	}
+
+	point_set->fingerprint = h != 0 ? h : 1;
+	return point_set->fingerprint;
+}
+
+// the cache key: the bitmask of the projected dimensions followed by the fingerprint of the base point set.
+// Called under cache_mutex, which also guards the fingerprint of bases shared between sessions.
+static string cache_key(projection_t* projection)
+{
+	int max_dim = 0;
+	for (int k = 0; k < projection->dim; k++)
+		max_dim = max(max_dim, projection->dims[k]);
+	vector<uint64_t> mask(max_dim / 64 + 1, 0);
+	for (int k = 0; k < projection->dim; k++)
+		mask[projection->dims[k] / 64] |= 1ULL << (projection->dims[k] % 64);
+
+	uint64_t h = fingerprint(projection->base);
+	string key((const char*)mask.data(), mask.size() * sizeof(uint64_t));
+	key.append((const char*)&h, sizeof(h));
+	return key;
+}
+
+// the memory bound, read once
+static size_t capacity()
+{
+	if (cache_capacity == 0)
+	{
+		const char* env = getenv("SKYLINE_CACHE_BYTES");
+		cache_capacity = (env != NULL && atoll(env) > 0) ? (size_t)atoll(env) : SKYLINE_CACHE_BYTES;
+	}
+	return cache_capacity;
+}
+
+// skyline of a projected point set, served from a process-wide LRU cache keyed by the projected dimensions
+// and the fingerprint of the base point set
+point_set_t* subspace_skyline(projection_t* projection)
+{
+	string key;
+	{
+		lock_guard<mutex> lock(cache_mutex);
+		key = cache_key(projection);
+		auto it = cache_index.find(key);
+		if (it != cache_index.end())
+		{
+			cache_stats.hits++;
+			cache_lru.splice(cache_lru.begin(), cache_lru, it->second);
+
+			const vector<int>& sl = it->second->skyline;
+			return project_points(projection, sl.data(), sl.size());
+		}
+		cache_stats.misses++;
+	}
+
+	// compute outside the lock so that sessions missing on different subspaces do not wait for each other;
+	// the skyline scan runs on one contiguous copy of the projection, of which only the skyline rows are kept
+	point_set_t* projected = project_points(projection, NULL, 0);
+	point_set_t* local = skyline_point(projected);
+
+	skyline_cache_entry e;
+	e.key = key;
+	e.skyline.resize(local->numberOfPoints);
+	for (int i = 0; i < local->numberOfPoints; i++)
+		e.skyline[i] = local->points[i] - projected->store->rows;
+	release_point_set(local, false);
+	release_point_set(projected, true);
+
+	point_set_t* skyline = project_points(projection, e.skyline.data(), e.skyline.size());
+
+	size_t bytes = entry_bytes(e);
+	lock_guard<mutex> lock(cache_mutex);
+	if (bytes <= capacity() && cache_index.find(key) == cache_index.end())
+	{
+		cache_lru.push_front(e);
+		cache_index[key] = cache_lru.begin();
+		cache_stats.entries++;
+		cache_stats.bytes += bytes;
+
+		// evict the least recently used entries
+		while (cache_stats.bytes > capacity())
+		{
+			skyline_cache_entry& last = cache_lru.back();
+			cache_stats.bytes -= entry_bytes(last);
+			cache_stats.entries--;
+			cache_stats.evictions++;
+			cache_index.erase(last.key);
+			cache_lru.pop_back();
+		}
+	}
+
+	return skyline;
+}
+
+// read the counters of the subspace skyline cache
+skyline_cache_stats_t skyline_cache_stats()
+{
+	lock_guard<mutex> lock(cache_mutex);
+	return cache_stats;
+}
+
+// drop every entry of the subspace skyline cache
+void skyline_cache_clear()
+{
+	lock_guard<mutex> lock(cache_mutex);
+	cache_lru.clear();
+	cache_index.clear();
+	cache_stats.entries = 0;
+	cache_stats.bytes = 0;
+}
@@ -0,0 +1,32 @@
+#ifndef SKYLINE_CACHE_H
+#define SKYLINE_CACHE_H
+
+#include "data_struct.h"
+
+// default memory bound of the subspace skyline cache, overridden by the SKYLINE_CACHE_BYTES environment variable
+#define SKYLINE_CACHE_BYTES (32 << 20)
+
+// counters of the subspace skyline cache
+typedef struct skyline_cache_stats
+{
+	long long	hits;
+	long long	misses;
+	long long	evictions;
+	size_t		entries;
+	size_t		bytes;
+
+}	skyline_cache_stats_t;
+
+// skyline of a projected point set, served from a process-wide LRU cache keyed by the projected dimensions
+// and a fingerprint of the base point set, hashed once per point set, so a base must not be modified once
+// projected. Only the skyline points are copied out of the base point set; the result owns them and is
+// released with release_point_set(skyline, true).
+point_set_t* subspace_skyline(projection_t* projection);
+
+// read the counters of the subspace skyline cache
+skyline_cache_stats_t skyline_cache_stats();
+
+// drop every entry of the subspace skyline cache
+void skyline_cache_clear();
+
+#endif // SKYLINE_CACHE_H
@@ -1,4 +1,14 @@
 #include "sphere.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <queue>
+#include <chrono>
+
+// per-round LP time and LP counts of the last sphereWSImpLP call
+static thread_local std::vector<double> lp_round_times;
+static thread_local sphere_lp_stats_t lp_stats;
 
 /*
 *	construct I in Sphere (Step 2)
@@ -276,6 +286,183 @@ point_set_t* search_basis(point_set_t* point_set_v, point_t* query)
 	return X;
 }
 
+// (p - q) . v, without allocating p - q
+static double dot_diff(point_t* p, point_t* q, point_t* v)
+{
+	double result = 0;
+	for (int i = 0; i < v->dim; i++)
+		result += (p->coord[i] - q->coord[i]) * v->coord[i];
+	return result;
+}
+
+// total time spent in the LPs of the N points
+static double lp_time(const double* lp_seconds, int N)
+{
+	double time = 0;
+	for (int i = 0; i < N; i++)
+		time += lp_seconds[i];
+	return time;
+}
+
+// worstDirection of pt against the first index points of s, on the LP of pt kept in wlp unless it is NULL, adding the time it takes to seconds
+static double timed_worst_direction(double& seconds, worst_direction_lp_t* wlp, int index, point_set_t* s, point_t* pt, double* v)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	double regret_ratio = wlp != NULL ? worstDirection(*wlp, index, s, pt, v) : worstDirection(index, s, pt, v);
+	seconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	return regret_ratio;
+}
+
+// seconds spent in the regret LPs of each ImpGreedy round of the last sphereWSImpLP call on this thread
+std::vector<double> sphere_lp_round_times()
+{
+	return lp_round_times;
+}
+
+// regret LPs solved and avoided by the lazy greedy in the last sphereWSImpLP call on this thread
+sphere_lp_stats_t sphere_lp_stats()
+{
+	return lp_stats;
+}
+
+// Number of threads solving the regret LPs: the SPHERE_THREADS environment variable if set, else the number of cores
+int sphere_threads()
+{
+	const char* env = getenv("SPHERE_THREADS");
+	if (env != NULL && atoi(env) > 0)
+		return atoi(env);
+
+	int cores = std::thread::hardware_concurrency();
+	return cores > 0 ? cores : 1;
+}
+
+// Whether sphereWSImpLP keeps the LP of each point across rounds and warm-starts it: the SPHERE_WARM_LP
+// environment variable set to a positive value. Off by default, since a cold dense solve of these LPs takes
+// only a few pivots and the kept tableaux measured slower
+bool sphere_warm_lps()
+{
+	const char* env = getenv("SPHERE_WARM_LP");
+	return env != NULL && atoi(env) > 0;
+}
+
+/*
+ * Threads running the per-point regret LPs of sphereWSImpLP, one contiguous shard of points each.
+ * A GLPK problem belongs to the environment of the thread that created it, so a point is always
+ * handled by the same thread: shard 0 runs on the calling thread and shard s > 0 on worker s,
+ * which frees its own GLPK environment when it exits.
+ */
+class lp_workers
+{
+public:
+	lp_workers(int shards) : shards(shards), generation(0), pending(0), stop(false)
+	{
+		for (int s = 1; s < shards; s++)
+			threads.push_back(std::thread(&lp_workers::work, this, s));
+	}
+
+	~lp_workers()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m);
+			stop = true;
+		}
+		wake.notify_all();
+		for (size_t i = 0; i < threads.size(); i++)
+			threads[i].join();
+	}
+
+	// run f(s) for every shard s and wait for all of them
+	void run(const std::function<void(int)>& f)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m);
+			job = f;
+			pending = shards - 1;
+			generation++;
+		}
+		wake.notify_all();
+
+		f(0);
+
+		std::unique_lock<std::mutex> lock(m);
+		done.wait(lock, [this] { return pending == 0; });
+	}
+
+	// first and one past the last point of shard s out of N points
+	int begin(int s, int N) const { return (int)((long long)N * s / shards); }
+	int end(int s, int N) const { return (int)((long long)N * (s + 1) / shards); }
+
+	const int shards;
+
+private:
+	void work(int s)
+	{
+		int seen = 0;
+		while (true)
+		{
+			std::function<void(int)> f;
+			{
+				std::unique_lock<std::mutex> lock(m);
+				wake.wait(lock, [&] { return stop || generation != seen; });
+				if (stop)
+					break;
+				seen = generation;
+				f = job;
+			}
+
+			f(s);
+
+			std::lock_guard<std::mutex> lock(m);
+			if (--pending == 0)
+				done.notify_one();
+		}
+		glp_free_env();
+	}
+
+	std::vector<std::thread> threads;
+	std::mutex m;
+	std::condition_variable wake, done;
+	std::function<void(int)> job;
+	int generation, pending;
+	bool stop;
+};
+
+// point with the maximum regret of one shard
+typedef struct shard_max
+{
+	double	worst;
+	int		index;	// -1 if no point has a positive regret
+}	shard_max_t;
+
+/*
+ * Point with the maximum regret over all shards. Shards cover increasing ranges of indices and only a
+ * strictly larger regret replaces the current one, so ties go to the smallest index whatever the
+ * number of threads, as in a sequential scan.
+ */
+static int reduce_max(const std::vector<shard_max_t>& best)
+{
+	int max = -1;
+	double worst = 0;
+	for (size_t s = 0; s < best.size(); s++)
+	{
+		if (worst < best[s].worst)
+		{
+			worst = best[s].worst;
+			max = best[s].index;
+		}
+	}
+	return max;
+}
+
+// order of the lazy greedy heap: larger regret bound first, then smaller index
+struct regret_order
+{
+	bool operator()(const std::pair<double, int>& a, const std::pair<double, int>& b) const
+	{
+		return a.first < b.first || (a.first == b.first && a.second > b.second);
+	}
+};
+
 // The complete Sphere algorithm
 point_set_t* sphereWSImpLP(point_set_t* point_set, int k)
 {
@@ -341,92 +528,155 @@ point_set_t* sphereWSImpLP(point_set_t* point_set, int k)
 
 	// Step 4: ImpGreedy
 	double epsilon = 0.0000001;
-	double worst, w;
-	point_t* max;
+	int max;
 	int* active = new int[point_set->numberOfPoints];
 
-	point_t* lastRound_max;
 	point_set_t* directions = alloc_point_set(N);
 	double *rr = new double[N];
 
-	// compute mrr_O(p) for each p in D
-	max = NULL;
-	worst = 0;
-	for (int i = 0; i< N; i++)
-	{	
-		active[i] = 1;
+	// seconds spent in the LPs of each point
+	double* lp_seconds = new double[N];
+	lp_round_times.clear();
+	lp_stats.solved = N;
+	lp_stats.avoided = 0;
+	lp_stats.warm = 0;
+
+	// the LP of each point, kept across rounds if enabled: a round only adds the rows of the points selected since
+	std::vector<worst_direction_lp_t> lps(sphere_warm_lps() ? N : 0);
+
+	// the LPs of different points are independent: shard them over the threads
+	lp_workers workers(std::max(1, std::min(sphere_threads(), N / SPHERE_MIN_SHARD)));
+	std::vector<shard_max_t> best(workers.shards);
 
+	for (int i = 0; i < N; i++)
+	{
+		active[i] = 1;
 		directions->points[i] = alloc_point(dim);
+	}
 
-		rr[i] = worstDirection(count, result, point_set->points[i], directions->points[i]->coord);
+	// compute mrr_O(p) for each p in D
+	workers.run([&](int s)
+	{
+		double local_worst = 0;
+		int local_max = -1;
+		for (int i = workers.begin(s, N); i < workers.end(s, N); i++)
+		{
+			lp_seconds[i] = 0;
+			rr[i] = timed_worst_direction(lp_seconds[i], lps.empty() ? NULL : &lps[i], count, result, point_set->points[i], directions->points[i]->coord);
 
-		w = rr[i];
-		if (worst<w)
-		{	
-			worst = w;
-			max = point_set->points[i];
+			if (local_worst < rr[i])
+			{
+				local_worst = rr[i];
+				local_max = i;
+			}
+			if (rr[i] <= 0.0 + epsilon)
+				active[i] = 0;
 		}
-		if (rr[i] <= 0.0 + epsilon)
-			active[i] = 0;
-	}
-	if (max == NULL)
+		best[s].worst = local_worst;
+		best[s].index = local_max;
+	});
+	max = reduce_max(best);
+	if (max == -1)
 	{
 		printf("Error: max is NULL\n");
 		exit(0);
 	}
-	result->points[count++] = max;
-	lastRound_max = max;
+	result->points[count++] = point_set->points[max];
+	lp_round_times.push_back(lp_time(lp_seconds, N));
+
+	/*
+	 * Lazy greedy: regrets only decrease as points are added, so the heap keeps the last regret rr[i] of
+	 * each remaining point as an upper bound, exact for the first valid[i] points of result. Only the
+	 * stale points reaching the top are refreshed; once the top is exact, no other point can beat it.
+	 */
+	int* valid = new int[N];
+	std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int> >, regret_order> heap;
+	for (int i = 0; i < N; i++)
+	{
+		valid[i] = count - 1;
+		if (i != max && active[i])
+			heap.push(std::make_pair(rr[i], i));
+	}
 
+	std::vector<int> batch;
 	while (count < k)
 	{
-		// Find a point with maximum regret
-		max = NULL;
-		worst = 0;
+		double round_start = lp_time(lp_seconds, N);
+		int candidates = heap.size();
+		int solved = 0;
 
-		for (int i = 0; i < N; i++)
+		while (true)
 		{
-			// upper bounding
-			if (worst > rr[i])
+			// take the stale points off the top, up to one LP per thread
+			while (!heap.empty() && valid[heap.top().second] < count && (int)batch.size() < workers.shards)
 			{
-				directions->points[i]->id = -2; // means the worst utility vector is outdated
-				continue;
+				int i = heap.top().second;
+				heap.pop();
+
+				// invariant checking: the last worst utility vector still gives regret rr[i] if no new point does better on it
+				bool holds = true;
+				for (int j = valid[i]; j < count && holds; j++)
+					holds = dot_diff(point_set->points[i], result->points[j], directions->points[i]) >= rr[i];
+				if (holds)
+				{
+					valid[i] = count;
+					heap.push(std::make_pair(rr[i], i));
+				}
+				else
+					batch.push_back(i);
 			}
-			// invariant checking fails or the worst utility vector is outdated
-			else if (directions->points[i]->id == -2 || dot_prod(sub(point_set->points[i], lastRound_max), directions->points[i]) < rr[i])
+			if (batch.empty())
+				break;
+
+			// solve the exact LPs, each on the thread owning the point
+			workers.run([&](int s)
 			{
-				// solve the exact LP
-				rr[i] = worstDirection(count, result, point_set->points[i], directions->points[i]->coord);
-				directions->points[i]->id = -1;
-			}
+				for (size_t b = 0; b < batch.size(); b++)
+				{
+					int i = batch[b];
+					if (i >= workers.begin(s, N) && i < workers.end(s, N))
+						rr[i] = timed_worst_direction(lp_seconds[i], lps.empty() ? NULL : &lps[i], count, result, point_set->points[i], directions->points[i]->coord);
+				}
+			});
+			solved += batch.size();
 
-			// update the current worst point
-			w = rr[i];
-			if (worst<w)
+			for (size_t b = 0; b < batch.size(); b++)
 			{
-				worst = w;
-				max = point_set->points[i];
+				int i = batch[b];
+				valid[i] = count;
+				if (rr[i] <= 0.0 + epsilon)
+					active[i] = 0;
+				else
+					heap.push(std::make_pair(rr[i], i));
 			}
-			if (w <= 0.0 + epsilon)
-				active[i] = 0;
+			batch.clear();
 		}
 
+		lp_round_times.push_back(lp_time(lp_seconds, N) - round_start);
+		lp_stats.solved += solved;
+		lp_stats.avoided += candidates - solved;
+
 		// Add a point if regret > 0. Otherwise, stop.
-		if (worst >= 0.0 + epsilon)
+		if (!heap.empty() && heap.top().first >= 0.0 + epsilon)
 		{
-			result->points[count++] = max;
-			lastRound_max = max;
+			result->points[count++] = point_set->points[heap.top().second];
+			heap.pop();
 		}
 		else
 		{
 			break;
 		}
 	}
+	delete[] valid;
+	for (int i = 0; i < (int) lps.size(); i++)
+		lp_stats.warm += lps[i].lp.warm_solves;
 
 	// fill in any remaining points with the first point
 	for (int j = count; j < k; ++j)
 		result->points[j] = result->points[0];
 
 
+	delete[] lp_seconds;
 	delete[] rr;
 	delete[] active;
 	delete[] b_value;
@@ -7,7 +7,32 @@
 
 #include "lp.h"
 
+// minimum number of points per thread in the regret LPs of sphereWSImpLP
+#define SPHERE_MIN_SHARD 4
+
 // The complete Sphere algorithm
 point_set_t* sphereWSImpLP(point_set_t* point_set, int k);
 
+// seconds spent in the regret LPs of each ImpGreedy round of the last sphereWSImpLP call on this thread
+// (entry 0 is the initial pass over all points)
+std::vector<double> sphere_lp_round_times();
+
+// regret LPs of the ImpGreedy rounds of sphereWSImpLP
+typedef struct sphere_lp_stats
+{
+	long long	solved;		// LPs solved, including the initial pass over all points
+	long long	avoided;	// LPs of a full re-evaluation of the remaining points each round that were not solved
+	long long	warm;		// LPs solved from the last optimal basis of the point, after adding the new rows
+
+}	sphere_lp_stats_t;
+
+// LP counts of the last sphereWSImpLP call on this thread
+sphere_lp_stats_t sphere_lp_stats();
+
+// number of threads solving the regret LPs of sphereWSImpLP (SPHERE_THREADS, else the number of cores)
+int sphere_threads();
+
+// whether sphereWSImpLP warm-starts the LP of each point across rounds (SPHERE_WARM_LP, off by default)
+bool sphere_warm_lps();
+
 #endif
\ No newline at end of file
@@ -490,13 +490,13 @@ typedef struct qhstatT qhstatT;
 __declspec(dllimport) extern qhstatT *qh_qhstat;
 #elif qh_QHpointer
 #define qhstat qh_qhstat->
-extern qhstatT *qh_qhstat;
+extern qh_THREADLOCAL qhstatT *qh_qhstat;
 #elif qh_dllimport
 #define qhstat qh_qhstat.
 __declspec(dllimport) extern qhstatT qh_qhstat;
 #else
 #define qhstat qh_qhstat.
-extern qhstatT qh_qhstat;
+extern qh_THREADLOCAL qhstatT qh_qhstat;
 #endif
 struct qhstatT {
   intrealT   stats[ZEND];     /* integer and real statistics */
@@ -594,6 +594,26 @@ stop after qh_JOGGLEmaxretry attempts
   see:
     user_eg.c for an example
 */
+/*-<a                             href="qh-user.htm#TOC"
+  >--------------------------------</a><a name="THREADLOCAL">-</a>
+
+  qh_THREADLOCAL
+    storage class of the global data structures qh_qh, qhmem, qh_qhstat, and qh_rand_seed
+
+  notes:
+    each thread has its own copy of the globals, so each thread is an
+    independent qhull context.  Separate threads may build hulls at the
+    same time, but a hull must be built and freed on the same thread.
+    also defined in mem.h, which does not include user.h
+*/
+#ifndef qh_THREADLOCAL
+#if defined(_MSC_VER)
+#define qh_THREADLOCAL __declspec(thread)
+#else
+#define qh_THREADLOCAL __thread
+#endif
+#endif
+
 #ifdef qh_QHpointer
 #if qh_dllimport
 #error QH6207 Qhull error: Use qh_QHpointer_dllimport instead of qh_dllimport with qh_QHpointer
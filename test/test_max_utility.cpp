@@ -0,0 +1,124 @@
+#include "../other/maxUtility.h"
+#include "../other/operation.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <random>
+#include <set>
+#include <string>
+
+using namespace std;
+
+/*
+ * Run max_utility on scripted answers with and without speculation (SPECULATE_THREADS) for both skyline
+ * options: the result, the number of questions and the candidates left must be the same. A stop answer
+ * (-99) must end the interaction at any round, also when it is the first answer of a speculative run.
+ */
+
+typedef struct run_result
+{
+	int		id;
+	double	Qcount;
+	double	Csize;
+
+}	run_result_t;
+
+// max_utility on the answers of script, with the options printed to /dev/null
+static run_result_t run(point_set_t* P_raw, point_set_t* P, const char* script, int spec_threads, int cmp_option, int prune_option)
+{
+	char path[] = "/tmp/test_max_utility_XXXXXX";
+	int fd = mkstemp(path);
+	if (fd < 0 || write(fd, script, strlen(script)) != (ssize_t)strlen(script))
+	{
+		printf("cannot write the answers to %s\n", path);
+		exit(1);
+	}
+	close(fd);
+	freopen(path, "r", stdin);
+
+	string threads = to_string(spec_threads);
+	setenv("SPECULATE_THREADS", threads.c_str(), 1);
+
+	fflush(stdout);
+	int saved_stdout = dup(1);
+	int null_fd = open("/dev/null", O_WRONLY);
+	dup2(null_fd, 1);
+	close(null_fd);
+
+	int dim = P->points[0]->dim;
+	set<int> dims;
+	for (int k = 0; k < dim; k++)
+		dims.insert(k);
+	point_t* u = alloc_point(dim);
+	for (int k = 0; k < dim; k++)
+		u->coord[k] = 1.0 / dim;
+
+	srand(7);
+	run_result_t r;
+	point_t* best = max_utility(P_raw, dims, P, u, 2, 0.0, 100, r.Qcount, r.Csize, cmp_option, NO_BOUND, prune_option, HYPER_PLANE);
+	r.id = best->id;
+	release_point(u);
+
+	fflush(stdout);
+	dup2(saved_stdout, 1);
+	close(saved_stdout);
+	unlink(path);
+	return r;
+}
+
+int main(int argc, char *argv[])
+{
+	mt19937 gen(20240607);
+	uniform_real_distribution<double> coordinate(0.0, 1.0);
+	int failures = 0;
+
+	const char* scripts[] = {"-99\n", "1 -99\n", "2 1 -99\n", "1 2 2 1 2 1 1 2 -99\n", "2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 2 -99\n"};
+	const char* prune_name[] = {"", "SQL", "RTREE"};
+
+	for (int d = 3; d <= 5; d++)
+	{
+		point_set_t* P_raw = alloc_point_set(2000, d);
+		for (int i = 0; i < P_raw->numberOfPoints; i++)
+		{
+			P_raw->points[i]->id = i;
+			for (int k = 0; k < d; k++)
+				P_raw->points[i]->coord[k] = coordinate(gen);
+		}
+		point_set_t* P = skyline_point(P_raw);
+
+		for (int cmp_option : {SIMPLEX, RANDOM})
+		{
+			for (int prune_option : {SQL, RTREE})
+			{
+				for (const char* script : scripts)
+				{
+					run_result_t plain = run(P_raw, P, script, 0, cmp_option, prune_option);
+					run_result_t ahead = run(P_raw, P, script, 2, cmp_option, prune_option);
+
+					// the stop answer is the first one after the scripted choices
+					int answers = 0;
+					for (const char* c = script; *c; c++)
+						answers += *c == '1' || *c == '2';
+					bool ok = plain.id == ahead.id && plain.Qcount == ahead.Qcount && plain.Csize == ahead.Csize &&
+						plain.Qcount <= answers + 1;
+					if (!ok)
+					{
+						printf("d=%d %s %s answers \"%.20s\": without speculation %d after %g questions (%g left), with %d after %g (%g left) MISMATCH\n",
+							d, cmp_option == SIMPLEX ? "SIMPLEX" : "RANDOM", prune_name[prune_option], script,
+							plain.id, plain.Qcount, plain.Csize, ahead.id, ahead.Qcount, ahead.Csize);
+						failures++;
+					}
+				}
+			}
+		}
+
+		printf("d=%d: %d skyline points, speculative and sequential runs compared\n", d, P->numberOfPoints);
+		release_point_set(P, false);
+		release_point_set(P_raw, true);
+	}
+
+	printf(failures == 0 ? "PASS\n" : "FAIL\n");
+	return failures == 0 ? 0 : 1;
+}
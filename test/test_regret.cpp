@@ -0,0 +1,115 @@
+#include "../other/lp.h"
+#include "../other/data_utility.h"
+
+#include <stdio.h>
+#include <cmath>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace std;
+
+/*
+ * Check evaluateMC against evaluateLP, which computes the exact maximum regret ratio from the worst direction
+ * of every point. A sampled maximum can never exceed the exact one, and with many utility vectors on few
+ * dimensions it must come close to it. Cases: random P and subsets S on 2 to 4 dimensions, S = P, and
+ * evaluateMC on a subset of the dimensions against evaluateLP on P and S projected to them.
+ */
+
+#define TEST_SAMPLES 200000
+
+static point_set_t* random_points(mt19937& gen, int n, int d)
+{
+	uniform_real_distribution<double> coordinate(0.0, 1.0);
+	point_set_t* p = alloc_point_set(n, d);
+	for (int i = 0; i < n; i++)
+	{
+		p->points[i]->id = i;
+		for (int k = 0; k < d; k++)
+			p->points[i]->coord[k] = coordinate(gen);
+	}
+	return p;
+}
+
+// the k first points of p, sharing their coordinates
+static point_set_t* prefix(point_set_t* p, int k)
+{
+	point_set_t* S = alloc_point_set(k);
+	for (int i = 0; i < k; i++)
+		S->points[i] = p->points[i];
+	return S;
+}
+
+// copies of the points of p on the dimensions dims
+static point_set_t* project(point_set_t* p, const set<int>& dims)
+{
+	point_set_t* q = alloc_point_set(p->numberOfPoints, dims.size());
+	for (int i = 0; i < p->numberOfPoints; i++)
+	{
+		q->points[i]->id = p->points[i]->id;
+		int k = 0;
+		for (int j : dims)
+			q->points[i]->coord[k++] = p->points[i]->coord[j];
+	}
+	return q;
+}
+
+// the sampled estimate must stay below the exact ratio and within tolerance of it
+static bool compare(const char* name, double exact, const regret_estimate_t& estimate, double tolerance)
+{
+	bool ok = estimate.max <= exact + 1e-9 && exact - estimate.max <= tolerance &&
+		estimate.mean >= 0 && estimate.mean <= estimate.max + 1e-12 && estimate.samples == TEST_SAMPLES;
+	printf("%-28s LP %.6f MC max %.6f mean %.6f +- %.6f %s\n", name, exact, estimate.max, estimate.mean,
+		estimate.mean_error, ok ? "ok" : "MISMATCH");
+	return ok;
+}
+
+int main(int argc, char *argv[])
+{
+	mt19937 gen(20240607);
+	int failures = 0;
+	char name[64];
+
+	for (int d = 2; d <= 4; d++)
+	{
+		for (int k : {1, 3, 8})
+		{
+			for (int round = 0; round < 3; round++)
+			{
+				point_set_t* P = random_points(gen, 200, d);
+				point_set_t* S = prefix(P, k);
+
+				double exact = evaluateLP(P, S, 0);
+				regret_estimate_t estimate = evaluateMC(P, S, 0, TEST_SAMPLES);
+				snprintf(name, sizeof(name), "d=%d |S|=%d #%d", d, k, round);
+				failures += !compare(name, exact, estimate, d == 2 ? 0.002 : d == 3 ? 0.01 : 0.03);
+
+				release_point_set(S, false);
+				release_point_set(P, true);
+			}
+		}
+	}
+
+	// no regret at all when S is P
+	point_set_t* P = random_points(gen, 200, 3);
+	regret_estimate_t same = evaluateMC(P, P, 0, TEST_SAMPLES);
+	if (same.max != 0 || same.mean != 0)
+	{
+		printf("S = P: MC max %g mean %g MISMATCH\n", same.max, same.mean);
+		failures++;
+	}
+
+	// a subset of the dimensions
+	set<int> dims = {0, 2};
+	point_set_t* S = prefix(P, 4);
+	point_set_t* P_dims = project(P, dims);
+	point_set_t* S_dims = project(S, dims);
+	failures += !compare("dims {0, 2} of d=3 |S|=4", evaluateLP(P_dims, S_dims, 0), evaluateMC(P, S, 0, TEST_SAMPLES, dims), 0.002);
+	release_point_set(S_dims, true);
+	release_point_set(P_dims, true);
+	release_point_set(S, false);
+	release_point_set(P, true);
+
+	printf(failures == 0 ? "PASS\n" : "FAIL\n");
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,504 @@
+#include "../other/simplex.h"
+#include <glpk.h>
+
+#include <stdio.h>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+/*
+ * Compare the dense simplex of simplex.h with GLPK on random LPs: general ones (optimal, infeasible and
+ * unbounded mixed), degenerate ones, constructed infeasible and unbounded ones, and LPs shaped as the four
+ * dense LPs of lp.cpp. The verdict and objective must agree with GLPK. An optimal dense solution must also
+ * carry its own certificate: primal feasibility, duals of the right sign and complementary slackness.
+ * Duals are compared with GLPK's where they are unique (the general LPs); degenerate LPs can have several
+ * optimal duals, there the certificate checks them. SIMPLEX_FAIL is accepted, as lp.cpp then uses GLPK.
+ * The LPs of only <= rows are also grown row by row as an incremental LP, whose warm-started solves must
+ * agree with solving each prefix from scratch.
+ */
+
+#define TEST_TOL 1e-6
+
+typedef struct test_lp
+{
+	const char*	kind;
+	dense_lp_t	lp;
+	bool		unique_duals;
+
+}	test_lp_t;
+
+typedef struct kind_stats
+{
+	const char*	kind;
+	int			count;
+	int			status[4];	// by dense status
+	int			mismatches;
+
+}	kind_stats_t;
+
+static double uniform(mt19937& gen, double lo, double hi)
+{
+	return uniform_real_distribution<double>(lo, hi)(gen);
+}
+
+static int uniform_int(mt19937& gen, int lo, int hi)
+{
+	return uniform_int_distribution<int>(lo, hi)(gen);
+}
+
+// random LP with coefficients and right-hand sides of both signs and all row and column types
+static test_lp_t general_lp(mt19937& gen)
+{
+	test_lp_t t;
+	t.kind = "general";
+	t.unique_duals = true;
+	int m = uniform_int(gen, 1, 12), n = uniform_int(gen, 1, 12);
+	init_dense_lp(t.lp, m, n, uniform_int(gen, 0, 1) == 1);
+	for (int i = 0; i < m; i++)
+	{
+		t.lp.row_type[i] = uniform_int(gen, 0, 3) == 0 ? SIMPLEX_EQ : SIMPLEX_LE;
+		t.lp.b[i] = uniform(gen, -1, 2);
+		for (int j = 0; j < n; j++)
+			t.lp.A[i * n + j] = uniform(gen, -1, 1);
+	}
+	for (int j = 0; j < n; j++)
+	{
+		int type = uniform_int(gen, 0, 5);
+		t.lp.col_type[j] = type == 0 ? SIMPLEX_FR : type == 1 ? SIMPLEX_UP : SIMPLEX_LO;
+		t.lp.ub[j] = uniform(gen, 0, 3);
+		t.lp.c[j] = uniform(gen, -1, 1);
+	}
+	return t;
+}
+
+// small integer coefficients, zero right-hand sides and repeated rows and columns: ties and degenerate pivots
+static test_lp_t degenerate_lp(mt19937& gen)
+{
+	test_lp_t t;
+	t.kind = "degenerate";
+	t.unique_duals = false;
+	int m = uniform_int(gen, 2, 16), n = uniform_int(gen, 2, 10);
+	init_dense_lp(t.lp, m, n, uniform_int(gen, 0, 1) == 1);
+	for (int i = 0; i < m; i++)
+	{
+		int copy = i > 0 && uniform_int(gen, 0, 2) == 0 ? uniform_int(gen, 0, i - 1) : -1;
+		t.lp.row_type[i] = uniform_int(gen, 0, 4) == 0 ? SIMPLEX_EQ : SIMPLEX_LE;
+		t.lp.b[i] = copy >= 0 ? t.lp.b[copy] : uniform_int(gen, 0, 2) == 0 ? uniform_int(gen, 1, 3) : 0;
+		for (int j = 0; j < n; j++)
+			t.lp.A[i * n + j] = copy >= 0 ? t.lp.A[copy * n + j] : uniform_int(gen, -1, 2);
+	}
+	for (int j = 0; j < n; j++)
+	{
+		int copy = j > 0 && uniform_int(gen, 0, 3) == 0 ? uniform_int(gen, 0, j - 1) : -1;
+		if (copy >= 0)
+			for (int i = 0; i < m; i++)
+				t.lp.A[i * n + j] = t.lp.A[i * n + copy];
+		t.lp.col_type[j] = uniform_int(gen, 0, 4) == 0 ? SIMPLEX_UP : SIMPLEX_LO;
+		t.lp.ub[j] = uniform_int(gen, 0, 2);
+		t.lp.c[j] = copy >= 0 ? t.lp.c[copy] : uniform_int(gen, -1, 1);
+	}
+	return t;
+}
+
+// a x <= b together with -a x <= -b - gap
+static test_lp_t infeasible_lp(mt19937& gen)
+{
+	test_lp_t t = general_lp(gen);
+	t.kind = "infeasible";
+	int m = t.lp.rows, n = t.lp.cols;
+	int i = uniform_int(gen, 0, m - 1), k = (i + 1) % m;
+	if (m == 1)
+	{
+		// no second row to use: an equality row that no point satisfies, 0 = 1
+		for (int j = 0; j < n; j++)
+			t.lp.A[j] = 0;
+		t.lp.row_type[0] = SIMPLEX_EQ;
+		t.lp.b[0] = 1;
+		return t;
+	}
+	t.lp.row_type[i] = t.lp.row_type[k] = SIMPLEX_LE;
+	for (int j = 0; j < n; j++)
+		t.lp.A[k * n + j] = -t.lp.A[i * n + j];
+	t.lp.b[k] = -t.lp.b[i] - uniform(gen, 0.01, 1);
+	return t;
+}
+
+// feasible at x = 0 with a column that can grow without bound and improves the objective
+static test_lp_t unbounded_lp(mt19937& gen)
+{
+	test_lp_t t;
+	t.kind = "unbounded";
+	t.unique_duals = false;
+	int m = uniform_int(gen, 1, 12), n = uniform_int(gen, 1, 12);
+	init_dense_lp(t.lp, m, n, uniform_int(gen, 0, 1) == 1);
+	int free_col = uniform_int(gen, 0, n - 1);
+	for (int i = 0; i < m; i++)
+	{
+		t.lp.b[i] = uniform(gen, 0, 2);
+		for (int j = 0; j < n; j++)
+			t.lp.A[i * n + j] = j == free_col ? -uniform(gen, 0, 1) : uniform(gen, -1, 1);
+	}
+	for (int j = 0; j < n; j++)
+		t.lp.c[j] = uniform(gen, -1, 1);
+	t.lp.c[free_col] = t.lp.maximize ? uniform(gen, 0.1, 1) : -uniform(gen, 0.1, 1);
+	return t;
+}
+
+static vector<double> random_point(mt19937& gen, int D)
+{
+	vector<double> p(D);
+	for (int j = 0; j < D; j++)
+		p[j] = uniform(gen, 0, 1);
+	return p;
+}
+
+// the worst direction LP of lp.cpp: some points of s repeat pt or each other
+static test_lp_t worst_direction_lp(mt19937& gen)
+{
+	test_lp_t t;
+	t.kind = "worst_direction";
+	t.unique_duals = false;
+	int D = uniform_int(gen, 2, 8), K = uniform_int(gen, 1, 30);
+	double epsilon = 0.0000000000001;
+	vector<double> pt = random_point(gen, D);
+	vector<vector<double> > s;
+	for (int i = 0; i < K; i++)
+	{
+		int kind = uniform_int(gen, 0, 5);
+		s.push_back(kind == 0 ? pt : kind == 1 && i > 0 ? s[uniform_int(gen, 0, i - 1)] : random_point(gen, D));
+	}
+
+	init_dense_lp(t.lp, K + 2, D + 1, true);
+	t.lp.col_type[D] = SIMPLEX_FR;
+	t.lp.c[D] = 1;
+	for (int i = 0; i < K; i++)
+	{
+		for (int j = 0; j < D; j++)
+			t.lp.A[i * (D + 1) + j] = -(pt[j] - s[i][j]);
+		t.lp.A[i * (D + 1) + D] = 1;
+	}
+	for (int j = 0; j < D; j++)
+	{
+		t.lp.A[K * (D + 1) + j] = pt[j];
+		t.lp.A[(K + 1) * (D + 1) + j] = -pt[j];
+	}
+	t.lp.b[K] = 1.0 + epsilon;
+	t.lp.b[K + 1] = -1.0 + epsilon;
+	return t;
+}
+
+// the inside-cone LP of lp.cpp, with pt a conical combination of the rays or a random point
+static test_lp_t inside_cone_lp(mt19937& gen)
+{
+	test_lp_t t;
+	t.kind = "inside_cone";
+	t.unique_duals = false;
+	int D = uniform_int(gen, 2, 8), M = uniform_int(gen, 1, 20);
+	vector<vector<double> > rays;
+	for (int j = 0; j < M; j++)
+		rays.push_back(random_point(gen, D));
+	vector<double> pt = random_point(gen, D);
+	if (uniform_int(gen, 0, 1) == 0)
+	{
+		for (int i = 0; i < D; i++)
+			pt[i] = 0;
+		for (int j = 0; j < M; j++)
+		{
+			double w = uniform_int(gen, 0, 2) == 0 ? 0 : uniform(gen, 0, 1);
+			for (int i = 0; i < D; i++)
+				pt[i] += w * rays[j][i];
+		}
+	}
+
+	init_dense_lp(t.lp, D, M, true);
+	for (int i = 0; i < D; i++)
+	{
+		t.lp.row_type[i] = SIMPLEX_EQ;
+		t.lp.b[i] = pt[i];
+		for (int j = 0; j < M; j++)
+			t.lp.A[i * M + j] = rays[j][i];
+	}
+	return t;
+}
+
+// the LP of solveLP in lp.cpp: min theta s.t. -theta mean + sum_j lambda_j B[j] = b
+static test_lp_t solve_lp_lp(mt19937& gen)
+{
+	test_lp_t t;
+	t.kind = "solveLP";
+	t.unique_duals = false;
+	int D = uniform_int(gen, 2, 8), M = uniform_int(gen, 1, 20) + 1;
+	vector<double> mean = random_point(gen, D), b = random_point(gen, D);
+
+	init_dense_lp(t.lp, D, M, false);
+	t.lp.c[0] = 1;
+	vector<vector<double> > B;
+	for (int j = 1; j < M; j++)
+		B.push_back(random_point(gen, D));
+	for (int i = 0; i < D; i++)
+	{
+		t.lp.row_type[i] = SIMPLEX_EQ;
+		t.lp.b[i] = b[i];
+		t.lp.A[i * M] = -mean[i];
+		for (int j = 1; j < M; j++)
+			t.lp.A[i * M + j] = B[j - 1][i];
+	}
+	return t;
+}
+
+// the find_feasible LP of lp.cpp on the hyperplanes (p_i - p_0) . u >= 0 of random points
+static test_lp_t find_feasible_lp(mt19937& gen)
+{
+	test_lp_t t;
+	t.kind = "find_feasible";
+	t.unique_duals = false;
+	int D = uniform_int(gen, 2, 8), M = uniform_int(gen, 1, 30);
+	vector<double> best = random_point(gen, D);
+
+	init_dense_lp(t.lp, M, D + 2, true);
+	for (int j = 0; j < D; j++)
+		t.lp.col_type[j] = SIMPLEX_FR;
+	t.lp.col_type[D + 1] = SIMPLEX_UP;
+	t.lp.ub[D + 1] = D + 1;
+	t.lp.c[D + 1] = 1;
+	for (int i = 0; i < M; i++)
+	{
+		vector<double> p = random_point(gen, D);
+		for (int j = 0; j < D; j++)
+			t.lp.A[i * (D + 2) + j] = p[j] - best[j];
+		t.lp.A[i * (D + 2) + D] = uniform(gen, -0.5, 0.5);
+		t.lp.A[i * (D + 2) + D + 1] = 1;
+	}
+	return t;
+}
+
+// solve with GLPK, returning the status in the SIMPLEX_* codes
+static int glpk_solve(const dense_lp_t& d, double& obj, vector<double>& dual)
+{
+	glp_prob* lp = glp_create_prob();
+	glp_set_obj_dir(lp, d.maximize ? GLP_MAX : GLP_MIN);
+	glp_add_rows(lp, d.rows);
+	glp_add_cols(lp, d.cols);
+	for (int i = 0; i < d.rows; i++)
+		glp_set_row_bnds(lp, i + 1, d.row_type[i] == SIMPLEX_EQ ? GLP_FX : GLP_UP, d.b[i], d.b[i]);
+	for (int j = 0; j < d.cols; j++)
+	{
+		if (d.col_type[j] == SIMPLEX_FR)
+			glp_set_col_bnds(lp, j + 1, GLP_FR, 0.0, 0.0);
+		else if (d.col_type[j] == SIMPLEX_UP)
+			glp_set_col_bnds(lp, j + 1, GLP_UP, 0.0, d.ub[j]);
+		else
+			glp_set_col_bnds(lp, j + 1, GLP_LO, 0.0, 0.0);
+		glp_set_obj_coef(lp, j + 1, d.c[j]);
+	}
+
+	vector<int> ind(d.cols + 1);
+	vector<double> val(d.cols + 1);
+	for (int i = 0; i < d.rows; i++)
+	{
+		int len = 0;
+		for (int j = 0; j < d.cols; j++)
+		{
+			if (d.A[i * d.cols + j] == 0)
+				continue;
+			len++;
+			ind[len] = j + 1;
+			val[len] = d.A[i * d.cols + j];
+		}
+		glp_set_mat_row(lp, i + 1, len, ind.data(), val.data());
+	}
+
+	glp_smcp parm;
+	glp_init_smcp(&parm);
+	parm.msg_lev = GLP_MSG_OFF;
+	glp_simplex(lp, &parm);
+
+	int status;
+	switch (glp_get_status(lp))
+	{
+		case GLP_OPT:		status = SIMPLEX_OPT; break;
+		case GLP_NOFEAS:	status = SIMPLEX_INFEAS; break;
+		case GLP_UNBND:		status = SIMPLEX_UNBND; break;
+		default:			status = SIMPLEX_FAIL; break;
+	}
+	obj = glp_get_obj_val(lp);
+	dual.assign(d.rows, 0);
+	for (int i = 0; i < d.rows; i++)
+		dual[i] = glp_get_row_dual(lp, i + 1);
+
+	glp_delete_prob(lp);
+	return status;
+}
+
+// check that the dense optimum is primal feasible and that its duals prove it optimal
+static bool check_certificate(const dense_lp_t& d, const char** why)
+{
+	double scale = 1;
+	for (int i = 0; i < d.rows; i++)
+		scale = max(scale, fabs(d.b[i]));
+	for (int j = 0; j < d.cols; j++)
+		scale = max(scale, fabs(d.x[j]));
+	double tol = TEST_TOL * scale;
+	double dir = d.maximize ? 1 : -1;
+
+	double cx = 0;
+	for (int j = 0; j < d.cols; j++)
+	{
+		cx += d.c[j] * d.x[j];
+		if ((d.col_type[j] == SIMPLEX_LO && d.x[j] < -tol) || (d.col_type[j] == SIMPLEX_UP && d.x[j] > d.ub[j] + tol))
+			return *why = "column bound violated", false;
+	}
+	if (fabs(cx - d.obj) > tol * (1 + fabs(d.obj)))
+		return *why = "objective is not c x", false;
+
+	for (int i = 0; i < d.rows; i++)
+	{
+		double ax = 0;
+		for (int j = 0; j < d.cols; j++)
+			ax += d.A[i * d.cols + j] * d.x[j];
+		double slack = d.b[i] - ax;
+		if (d.row_type[i] == SIMPLEX_EQ ? fabs(slack) > tol : slack < -tol)
+			return *why = "row violated", false;
+
+		// a <= row has a dual of the sign of the optimization direction, zero unless the row is tight
+		if (d.row_type[i] == SIMPLEX_LE && (dir * d.dual[i] < -tol || fabs(d.dual[i] * slack) > tol))
+			return *why = "row dual", false;
+	}
+
+	for (int j = 0; j < d.cols; j++)
+	{
+		double reduced = d.c[j];
+		for (int i = 0; i < d.rows; i++)
+			reduced -= d.dual[i] * d.A[i * d.cols + j];
+		reduced *= dir;
+
+		// as a maximization: no improving direction within the bounds of the column
+		if (d.col_type[j] == SIMPLEX_FR && fabs(reduced) > tol)
+			return *why = "reduced cost of a free column", false;
+		if (d.col_type[j] == SIMPLEX_LO && (reduced > tol || fabs(reduced * d.x[j]) > tol))
+			return *why = "reduced cost of a column >= 0", false;
+		if (d.col_type[j] == SIMPLEX_UP && (reduced < -tol || fabs(reduced * (d.ub[j] - d.x[j])) > tol))
+			return *why = "reduced cost of a column <= ub", false;
+	}
+	return true;
+}
+
+/*
+ * Grow the LP of t row by row as an incremental LP, solving after each row, and compare every solve with
+ * solve_dense_lp on the same rows. Returns NULL if they agree; warm counts the warm-started solves.
+ */
+static const char* check_incremental(const test_lp_t& t, long long& warm)
+{
+	const dense_lp_t& d = t.lp;
+	incremental_lp_t ilp;
+	init_incremental_lp(ilp, d.cols, d.maximize, d.rows);
+	ilp.lp.col_type = d.col_type;
+	ilp.lp.ub = d.ub;
+	ilp.lp.c = d.c;
+
+	for (int i = 0; i < d.rows; i++)
+	{
+		add_incremental_row(ilp, &d.A[i * d.cols], d.b[i]);
+		int status = solve_incremental_lp(ilp);
+
+		dense_lp_t cold = ilp.lp;
+		int expected = solve_dense_lp(cold);
+		const char* why = NULL;
+		if (status == SIMPLEX_FAIL || expected == SIMPLEX_FAIL)
+			continue;
+		if (status != expected)
+			return "incremental status differs from a solve from scratch";
+		if (status == SIMPLEX_OPT && fabs(cold.obj - ilp.lp.obj) > TEST_TOL * (1 + fabs(cold.obj)))
+			return "incremental objective differs from a solve from scratch";
+		if (status == SIMPLEX_OPT && !check_certificate(ilp.lp, &why))
+			return why;
+	}
+	warm += ilp.warm_solves;
+	return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+	int per_kind = argc > 1 ? atoi(argv[1]) : 2000;
+	mt19937 gen(20240607);
+
+	test_lp_t (*generators[])(mt19937&) = {general_lp, degenerate_lp, infeasible_lp, unbounded_lp,
+		worst_direction_lp, inside_cone_lp, solve_lp_lp, find_feasible_lp};
+	const char* status_name[] = {"optimal", "infeasible", "unbounded", "fail"};
+	int failures = 0;
+
+	for (auto generate : generators)
+	{
+		kind_stats_t stats = {NULL, 0, {0, 0, 0, 0}, 0};
+		for (int k = 0; k < per_kind; k++)
+		{
+			test_lp_t t = generate(gen);
+			stats.kind = t.kind;
+			stats.count++;
+
+			int status = solve_dense_lp(t.lp);
+			stats.status[status]++;
+			if (status == SIMPLEX_FAIL)
+				continue;
+
+			double obj;
+			vector<double> dual;
+			int expected = glpk_solve(t.lp, obj, dual);
+			const char* why = NULL;
+			if (status != expected)
+				why = "status differs from GLPK";
+			else if (status == SIMPLEX_OPT && fabs(obj - t.lp.obj) > TEST_TOL * (1 + fabs(obj)))
+				why = "objective differs from GLPK";
+			else if (status == SIMPLEX_OPT && !check_certificate(t.lp, &why))
+				;
+			else if (status == SIMPLEX_OPT && t.unique_duals)
+			{
+				for (int i = 0; i < t.lp.rows && why == NULL; i++)
+					if (fabs(dual[i] - t.lp.dual[i]) > TEST_TOL * (1 + fabs(dual[i])))
+						why = "dual differs from GLPK";
+			}
+
+			if (why != NULL)
+			{
+				stats.mismatches++;
+				if (stats.mismatches <= 5)
+					printf("%s #%d (%d x %d): %s (dense %s %.10g, GLPK %s %.10g)\n", t.kind, k, t.lp.rows, t.lp.cols, why,
+						status_name[status], t.lp.obj, status_name[expected], obj);
+			}
+		}
+
+		printf("%-16s %5d LPs: %5d optimal %5d infeasible %5d unbounded %5d left to GLPK, %d mismatches\n", stats.kind,
+			stats.count, stats.status[SIMPLEX_OPT], stats.status[SIMPLEX_INFEAS], stats.status[SIMPLEX_UNBND],
+			stats.status[SIMPLEX_FAIL], stats.mismatches);
+		failures += stats.mismatches;
+	}
+
+	for (auto generate : generators)
+	{
+		const char* kind = NULL;
+		int count = 0, mismatches = 0;
+		long long warm = 0;
+		for (int k = 0; k < per_kind; k++)
+		{
+			test_lp_t t = generate(gen);
+			kind = t.kind;
+			if (find(t.lp.row_type.begin(), t.lp.row_type.end(), SIMPLEX_EQ) != t.lp.row_type.end())
+				continue;
+			count++;
+
+			const char* why = check_incremental(t, warm);
+			if (why != NULL && ++mismatches <= 5)
+				printf("%s #%d (%d x %d): %s\n", t.kind, k, t.lp.rows, t.lp.cols, why);
+		}
+
+		printf("%-16s %5d incremental LPs: %6lld warm-started solves, %d mismatches\n", kind, count, warm, mismatches);
+		failures += mismatches;
+	}
+
+	glp_free_env();
+	printf(failures == 0 ? "PASS\n" : "FAIL\n");
+	return failures == 0 ? 0 : 1;
+}
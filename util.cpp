@@ -1,16 +1,18 @@
 #include "util.h"
 
 
-int show_to_user(point_set_t* P_raw, point_set_t* S, std::set<int> selected_dimensions, point_t* u){
+// print a dimension question (phase 1 or 2) and read the answer as typed
+static int ask_dimensions(point_set_t* P_raw, const session_question_t* q){
+    const std::set<int>& selected_dimensions = q->dimensions;
     int m = selected_dimensions.size();
-    int size = S->numberOfPoints;
+    int size = q->ids.size();
 
     // print S
     printf("S:\n");
     for (int j = 0; j < size; ++j) {
         printf("Point %d: ", j);
         for (int k = 0; k < m; ++k) {
-            printf("%f ", S->points[j]->coord[k]);
+            printf("%f ", q->coords[j * m + k]);
         }
         printf("\n");
     }
@@ -26,7 +28,7 @@ int show_to_user(point_set_t* P_raw, point_set_t* S, std::set<int> selected_dime
     for (int j = 0; j < size; ++j) {
         printf("|%10s", ("Option" + std::to_string(j+1)).c_str());
         for (int k = 0; k < m; ++k) {
-            printf("|%10.3f", P_raw->points[S->points[j]->id]->coord[*next(selected_dimensions.begin(), k)]);
+            printf("|%10.3f", raw_coord(P_raw, q->ids[j], *next(selected_dimensions.begin(), k)));
         }
         printf("|\n");
     }
@@ -36,7 +38,43 @@ int show_to_user(point_set_t* P_raw, point_set_t* S, std::set<int> selected_dime
     // scanf("%d", &maxIdx);
     // while the input is not in {0,1,2,...,size}
     while (maxIdx != 0 && maxIdx != 1 && maxIdx != 2 && maxIdx != -99){
-        scanf("%d", &maxIdx);
+        // no answer can come from a closed or unreadable input, stop the run
+        if (scanf("%d", &maxIdx) != 1)
+            exit(1);
+    }
+    return maxIdx;
+}
+
+int ask_user(point_set_t* P_raw, const session_question_t* q){
+    if (q->phase == 3) {
+        print_options(P_raw, q->dimensions, q->ids);
+        return scan_answer();
+    }
+    return ask_dimensions(P_raw, q);
+}
+
+int show_to_user(point_set_t* P_raw, point_set_t* S, std::set<int> selected_dimensions, point_t* u){
+    int m = selected_dimensions.size();
+    session_t* ss = current_session();
+
+    session_question_t q;
+    q.phase = ss != NULL ? ss->phase : 1;
+    q.dimensions = selected_dimensions;
+    for (int j = 0; j < S->numberOfPoints; ++j) {
+        q.ids.push_back(S->points[j]->id);
+        for (int k = 0; k < m; ++k) {
+            q.coords.push_back(S->points[j]->coord[k]);
+        }
+    }
+
+    // inside a session the question goes to its caller instead of stdin/stdout
+    int maxIdx;
+    if (ss != NULL) {
+        session_post(q.phase, q.dimensions, q.ids, q.coords);
+        maxIdx = session_wait();
+    }
+    else {
+        maxIdx = ask_dimensions(P_raw, &q);
     }
     return maxIdx==-99 ? -99 : maxIdx-1;
     // // construct u_selected
@@ -63,31 +101,18 @@ int show_to_user(point_set_t* P_raw, point_set_t* S, std::set<int> selected_dime
 point_set_t* generate_S(point_set_t* P, std::set<int> selected_dimensions, int size){
     //Restrict D to dimensions i*d_hat, i*d_hat+1, ..., i*d_hat+d_hat-1
     int n = P->numberOfPoints;
-    point_set_t* D = alloc_point_set(n);
-    for (int j=0;j<n;++j){
-        D->points[j] = alloc_point(selected_dimensions.size());
-        D->points[j]->id = P->points[j]->id;
-        for (int p=0;p<selected_dimensions.size();++p){
-            D->points[j]->coord[p] = P->points[j]->coord[*next(selected_dimensions.begin(), p)];
-        }
-    }
-    point_set_t* S = alloc_point_set(size);
+    projection_t* D = alloc_projection(P, selected_dimensions);
     // select randomly size points from D
     // create a random number generator
     std::random_device rd;
     std::mt19937 gen(rd());
     std::uniform_int_distribution<int> dis(0, n-1);
-    // select size points from D
+    // select size points from D, copying only their projected coordinates
+    std::vector<int> idx(size);
     for (int j = 0; j < size; ++j) {
-        int idx = dis(gen);
-        // S->points[j] = D->points[idx];
-        // allocate a new point
-        S->points[j] = alloc_point(selected_dimensions.size());
-        S->points[j]->id = D->points[idx]->id;
-        for (int p=0;p<selected_dimensions.size();++p){
-            S->points[j]->coord[p] = D->points[idx]->coord[p];
-        }
+        idx[j] = dis(gen);
     }
-    release_point_set(D, true);
+    point_set_t* S = project_points(D, idx.data(), size);
+    release_projection(D);
     return S;
 }
\ No newline at end of file
@@ -24,4 +24,7 @@ using namespace std;
 
 int show_to_user(point_set_t* P_raw, point_set_t* S, std::set<int> selected_dimensions, point_t* u);
 
+// print a question of a session and read the answer as typed (0 for not interested, i for option i, -99 to stop)
+int ask_user(point_set_t* P_raw, const session_question_t* q);
+
 point_set_t* generate_S(point_set_t* P, std::set<int> selected_dimensions, int size);
\ No newline at end of file
@@ -15,7 +15,7 @@ static std::string get_session_filepath() {
     const char* dir = std::getenv("DATA_DIR");
     std::string base = (dir && *dir) ? std::string(dir) : std::string("/data");
     if (!base.empty() && base.back() == '/') base.pop_back();
-    const char* sid = std::getenv("SESSION_ID");
+    const char* sid = session_name();
     std::string sessionId = sid ? std::string(sid) : std::string("default");
     std::string folder = base + "/sessions";
     ensure_dir(folder);
@@ -101,9 +101,11 @@ static void append_interaction_record(const std::vector<int>& ids,
     out.close();
 }
 
-int show_to_user(point_set_t* P_raw, point_set_t* S, std::set<int> selected_dimensions, point_t* u){
+// print a dimension question (phase 1 or 2) and read the answer as typed
+static int ask_dimensions(point_set_t* P_raw, const session_question_t* q){
+    const std::set<int>& selected_dimensions = q->dimensions;
     int m = selected_dimensions.size();
-    int size = S->numberOfPoints;
+    int size = q->ids.size();
 
     // Skip printing S details - not needed for user interaction
 
@@ -118,7 +120,7 @@ int show_to_user(point_set_t* P_raw, point_set_t* S, std::set<int> selected_dime
     for (int j = 0; j < size; ++j) {
         printf("|%10s", ("Option" + std::to_string(j+1)).c_str());
         for (int k = 0; k < m; ++k) {
-            printf("|%10.3f", P_raw->points[S->points[j]->id]->coord[*next(selected_dimensions.begin(), k)]);
+            printf("|%10.3f", raw_coord(P_raw, q->ids[j], *next(selected_dimensions.begin(), k)));
         }
         printf("|\n");
     }
@@ -132,6 +134,10 @@ int show_to_user(point_set_t* P_raw, point_set_t* S, std::set<int> selected_dime
     // Accept any integer in [0..size] or -99 to stop
     while (true) {
         int rc = scanf("%d", &maxIdx);
+        if (rc == EOF) {
+            // the client closed the connection, no answer will come
+            exit(1);
+        }
         if (rc != 1) {
             // Clear invalid token
             int ch;
@@ -146,12 +152,43 @@ int show_to_user(point_set_t* P_raw, point_set_t* S, std::set<int> selected_dime
         printf("Out of range. Enter 0..%d or -99 to stop: ", size);
         fflush(stdout);
     }
+    return maxIdx;
+}
 
-    // Prepare interaction record
-    std::vector<int> shown_ids;
+int ask_user(point_set_t* P_raw, const session_question_t* q){
+    if (q->phase == 3) {
+        print_options(P_raw, q->dimensions, q->ids);
+        return scan_answer();
+    }
+    return ask_dimensions(P_raw, q);
+}
+
+int show_to_user(point_set_t* P_raw, point_set_t* S, std::set<int> selected_dimensions, point_t* u){
+    int m = selected_dimensions.size();
+    int size = S->numberOfPoints;
+    session_t* ss = current_session();
+
+    session_question_t q;
+    q.phase = ss != NULL ? ss->phase : 1;
+    q.dimensions = selected_dimensions;
     for (int j = 0; j < size; ++j) {
-        shown_ids.push_back(S->points[j]->id);
+        q.ids.push_back(S->points[j]->id);
+        for (int k = 0; k < m; ++k) {
+            q.coords.push_back(S->points[j]->coord[k]);
+        }
+    }
+
+    // inside a session the question goes to its caller instead of stdin/stdout
+    int maxIdx;
+    if (ss != NULL) {
+        session_post(q.phase, q.dimensions, q.ids, q.coords);
+        maxIdx = session_wait();
+    }
+    else {
+        maxIdx = ask_dimensions(P_raw, &q);
     }
+
+    // Prepare interaction record
     std::vector<int> attributes;
     for (int dim : selected_dimensions) attributes.push_back(dim);
 
@@ -160,7 +197,7 @@ int show_to_user(point_set_t* P_raw, point_set_t* S, std::set<int> selected_dime
     // Append to user_feedback.json for any answered question (including Not Interested = -1),
     // only discard when the user stops (-99)
     if (chosen != -99) {
-        append_interaction_record(shown_ids, attributes, chosen);
+        append_interaction_record(q.ids, attributes, chosen);
     }
 
     return chosen;
@@ -169,31 +206,18 @@ int show_to_user(point_set_t* P_raw, point_set_t* S, std::set<int> selected_dime
 point_set_t* generate_S(point_set_t* P, std::set<int> selected_dimensions, int size){
     //Restrict D to dimensions i*d_hat, i*d_hat+1, ..., i*d_hat+d_hat-1
     int n = P->numberOfPoints;
-    point_set_t* D = alloc_point_set(n);
-    for (int j=0;j<n;++j){
-        D->points[j] = alloc_point(selected_dimensions.size());
-        D->points[j]->id = P->points[j]->id;
-        for (int p=0;p<selected_dimensions.size();++p){
-            D->points[j]->coord[p] = P->points[j]->coord[*next(selected_dimensions.begin(), p)];
-        }
-    }
-    point_set_t* S = alloc_point_set(size);
+    projection_t* D = alloc_projection(P, selected_dimensions);
     // select randomly size points from D
     // create a random number generator
     std::random_device rd;
     std::mt19937 gen(rd());
     std::uniform_int_distribution<int> dis(0, n-1);
-    // select size points from D
+    // select size points from D, copying only their projected coordinates
+    std::vector<int> idx(size);
     for (int j = 0; j < size; ++j) {
-        int idx = dis(gen);
-        // S->points[j] = D->points[idx];
-        // allocate a new point
-        S->points[j] = alloc_point(selected_dimensions.size());
-        S->points[j]->id = D->points[idx]->id;
-        for (int p=0;p<selected_dimensions.size();++p){
-            S->points[j]->coord[p] = D->points[idx]->coord[p];
-        }
+        idx[j] = dis(gen);
     }
-    release_point_set(D, true);
+    point_set_t* S = project_points(D, idx.data(), size);
+    release_projection(D);
     return S;
 }
\ No newline at end of file
@@ -6,6 +6,7 @@ This version uses polling instead of WebSockets to avoid compatibility issues.
 
 import os
 import sys
+import socket
 import subprocess
 import threading
 import time
@@ -31,13 +32,27 @@ sessions_lock = threading.Lock()
 uh_sessions = {}
 uh_sessions_lock = threading.Lock()
 
+# With ENGINE_DAEMON_SOCKET set, sessions run in the engine daemon (./run_daemon) listening on that Unix
+# socket; with ENGINE_ZYGOTE_SOCKET set, each session is a child forked by ./run_web --zygote listening on
+# that socket, which loads the dataset once. Either is started on first use if nothing listens there;
+# otherwise each session spawns its own ./run_web
+ENGINE_DAEMON_SOCKET = os.environ.get('ENGINE_DAEMON_SOCKET')
+ENGINE_ZYGOTE_SOCKET = os.environ.get('ENGINE_ZYGOTE_SOCKET')
+
+def new_runner(session_id):
+    if ENGINE_DAEMON_SOCKET:
+        return DaemonAlgorithmRunner(ENGINE_DAEMON_SOCKET, session_id)
+    if ENGINE_ZYGOTE_SOCKET:
+        return ZygoteAlgorithmRunner(ENGINE_ZYGOTE_SOCKET, session_id)
+    return AlgorithmRunner()
+
 def get_runner(session_id, create_if_missing=False):
     if not session_id:
         return None
     with sessions_lock:
         runner = sessions.get(session_id)
         if runner is None and create_if_missing:
-            runner = AlgorithmRunner()
+            runner = new_runner(session_id)
             sessions[session_id] = runner
         return runner
 
@@ -129,6 +144,10 @@ def append_json_array(filepath, item):
     with open(filepath, 'w') as f:
         json.dump(data, f, indent=2)
 
+def dataset_file():
+    """The dataset at repo root: the binary car.bin if it was converted, else car.txt"""
+    return 'car.bin' if os.path.exists('car.bin') else 'car.txt'
+
 class AlgorithmRunner:
     def __init__(self):
         self.process = None
@@ -138,9 +157,6 @@ class AlgorithmRunner:
     def start_algorithm(self, dataset_path="car.txt", use_real=False):
         """Start the C++ algorithm process"""
         try:
-            # Ensure output directory exists for C++ intermediate files
-            os.makedirs('output', exist_ok=True)
-            
             # Build only if binary is missing and not explicitly skipped
             skip_build = os.environ.get('SKIP_BUILD', '0') == '1'
             if not skip_build and not os.path.exists('./run_web'):
@@ -254,6 +270,261 @@ class AlgorithmRunner:
         dlog(f"[{id(self)}] get_status running={self.is_running} lines={len(self.output_lines)}")
         return state
 
+engine_lock = threading.Lock()
+engine_processes = {}
+
+def connect_engine(path, command, make_target):
+    """Connect to the engine listening on the Unix socket at path, starting command (built with make_target
+    if missing) first if nothing listens"""
+    with engine_lock:
+        for attempt in range(100):
+            sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+            try:
+                sock.connect(path)
+                return sock
+            except OSError:
+                sock.close()
+            process = engine_processes.get(path)
+            if process is None or process.poll() is not None:
+                skip_build = os.environ.get('SKIP_BUILD', '0') == '1'
+                if not skip_build and not os.path.exists(command[0]):
+                    print(f"Building {command[0]}...")
+                    result = subprocess.run(["make", make_target], capture_output=True, text=True)
+                    if result.returncode != 0:
+                        raise RuntimeError(f"Build failed: {result.stderr}")
+                dlog(f"starting {' '.join(command)}")
+                engine_processes[path] = subprocess.Popen(command, env=os.environ.copy())
+            time.sleep(0.1)
+        raise RuntimeError(f"{command[0]} not reachable at {path}")
+
+def connect_daemon(path):
+    """Connect to the engine daemon at path, starting ./run_daemon there first if nothing listens; it reads
+    datasets from the working directory only"""
+    return connect_engine(path, ["./run_daemon", path, os.getcwd()], "daemon")
+
+def connect_zygote(path, dataset_path):
+    """Connect to the zygote at path, starting ./run_web --zygote there on dataset_path first if nothing
+    listens. A running zygote keeps serving the dataset it was started on."""
+    return connect_engine(path, ["./run_web", "--zygote", path, dataset_path], "web-real")
+
+class ZygoteAlgorithmRunner(AlgorithmRunner):
+    """Runs a session in a child of the zygote (run_web --zygote), one connection per session. After the
+    session id line the connection is the stdin/stdout of the child, so its output is the one of run_web.
+    Closing the connection ends the child at its next question."""
+
+    def __init__(self, socket_path, session_id):
+        super().__init__()
+        self.socket_path = socket_path
+        self.session_id = session_id
+        self.sock = None
+        self.stream = None
+
+    def start_algorithm(self, dataset_path="car.txt", use_real=False):
+        """Start a session in a child of the zygote; its output is read on a thread of its own"""
+        try:
+            sock = connect_zygote(self.socket_path, dataset_path)
+            # the output is read on one thread and the answers written on others, through files of their own
+            stream = sock.makefile('w', encoding='utf-8', newline='\n')
+            stream.write((self.session_id or '').replace('\n', ' ') + '\n')
+            stream.flush()
+        except Exception as e:
+            dlog(f"[{id(self)}] failed to start: {e}")
+            return False, f"Failed to start algorithm: {str(e)}"
+
+        self.sock = sock
+        self.stream = stream
+        self.is_running = True
+        self.output_lines = []
+        threading.Thread(target=self._read_output, args=(sock, sock.makefile('r', encoding='utf-8', newline='\n')), daemon=True).start()
+        dlog(f"[{id(self)}] started in zygote dataset={dataset_path}")
+        return True, "Algorithm started successfully"
+
+    def _read_output(self, sock, output):
+        """Read the output of the child until it closes the connection"""
+        try:
+            for line in output:
+                line_s = line.rstrip('\n')
+                self.output_lines.append(line_s)
+                if line_s:
+                    dlog(f"[{id(self)}] out: {line_s[:180]}")
+        except Exception as e:
+            dlog(f"[{id(self)}] read error: {e}")
+        output.close()
+        dlog(f"[{id(self)}] zygote session ended")
+        if self.sock is sock:
+            self.is_running = False
+
+    def send_input(self, user_input):
+        """Send user input to the child"""
+        if self.stream and self.is_running:
+            try:
+                self.stream.write(user_input + '\n')
+                self.stream.flush()
+                dlog(f"[{id(self)}] in: {user_input}")
+                return True
+            except Exception as e:
+                dlog(f"[{id(self)}] send error: {e}")
+                return False
+        return False
+
+    def stop_algorithm(self):
+        """Close the connection; the child exits once it reads the end of its input"""
+        self.is_running = False
+        if self.sock:
+            try:
+                self.sock.shutdown(socket.SHUT_RDWR)
+                self.stream.close()
+            except OSError:
+                pass
+            self.sock.close()
+            self.sock = None
+            self.stream = None
+
+class DaemonAlgorithmRunner(AlgorithmRunner):
+    """Runs a session in the engine daemon (main_daemon.cpp), one connection per session. Its replies are
+    rendered as the lines run_web prints, so the page reads both the same way. Closing the connection
+    releases the session in the daemon."""
+
+    PHASES = {
+        1: 'Phase 1: Initializing dimension selection...',
+        2: 'Phase 2: Refining dimension selection...',
+        3: 'Phase 3: Starting interactive questioning...',
+    }
+    RULE = '-' * 78
+
+    def __init__(self, socket_path, session_id):
+        super().__init__()
+        self.socket_path = socket_path
+        self.session_id = session_id
+        self.sock = None
+        self.sid = None
+        self.phase = None
+        self.send_lock = threading.Lock()
+
+    def start_algorithm(self, dataset_path="car.txt", use_real=False):
+        """Start a session in the daemon; the replies are read on a thread of their own"""
+        try:
+            sock = connect_daemon(self.socket_path)
+        except Exception as e:
+            dlog(f"[{id(self)}] failed to start: {e}")
+            return False, f"Failed to start algorithm: {str(e)}"
+
+        self.sock = sock
+        self.sid = None
+        self.phase = None
+        self.output_lines = ['Initializing algorithm phases...']
+        self.is_running = True
+        threading.Thread(target=self._read_replies, args=(sock,), daemon=True).start()
+
+        # the session file is named after the browser session, which must be a single word of the protocol
+        request = f"start {dataset_path}"
+        if self.session_id and len(self.session_id.split()) == 1:
+            request += f" {self.session_id}"
+        if not self._send(request):
+            return False, "Failed to start algorithm: engine daemon closed the connection"
+        dlog(f"[{id(self)}] started in daemon dataset={dataset_path}")
+        return True, "Algorithm started successfully"
+
+    def _send(self, line):
+        try:
+            with self.send_lock:
+                self.sock.sendall((line + '\n').encode())
+            return True
+        except Exception as e:
+            dlog(f"[{id(self)}] send error: {e}")
+            return False
+
+    def _options(self, options):
+        """The options of a reply as (id, values) from '<id>:<value>,<value>,...' words"""
+        rows = []
+        for option in options:
+            option_id, values = option.split(':', 1)
+            rows.append((int(option_id), [float(v) for v in values.split(',')] if values else []))
+        return rows
+
+    def _render_question(self, phase, dims, rows):
+        if phase != self.phase:
+            self.phase = phase
+            self.output_lines.append(self.PHASES.get(phase, f'Phase {phase}'))
+        lines = ['', 'Please choose the option you favor more:']
+        if phase == 3:
+            # as print_options in maxUtility.cpp
+            lines.append('dimensions: ')
+            lines.append(''.join(f'|{d:>10}' for d in dims) + '|')
+            lines.append('-' * 65)
+            lines += [''.join(f'|{v:>10.3f}' for v in values) + '|' for _, values in rows]
+            lines.append('-' * 65)
+        else:
+            # as ask_dimensions in util_web.cpp
+            lines.append(f'|{"Options":>10}' + ''.join(f'|{d:>10}' for d in dims) + '|')
+            lines.append(self.RULE)
+            lines += [f'|{"Option" + str(j + 1):>10}' + ''.join(f'|{v:>10.3f}' for v in values) + '|'
+                      for j, (_, values) in enumerate(rows)]
+            lines.append(self.RULE)
+        lines.append('Your choice (0 for not interested): ')
+        self.output_lines.extend(lines)
+
+    def _render_done(self, dims, rows):
+        # as the end of main_web_real.cpp
+        self.output_lines += ['', '=== FINAL RECOMMENDATION ===']
+        for option_id, values in rows:
+            self.output_lines.append(f'Option {option_id}: ' + ''.join(f'dim {d}: {v:.4f} ' for d, v in zip(dims, values)))
+        self.output_lines += ['', '=== DONE ===']
+
+    def _read_replies(self, sock):
+        """Turn the replies of the daemon into output lines until the session ends"""
+        try:
+            for line in sock.makefile('r'):
+                words = line.split()
+                if not words:
+                    continue
+                dlog(f"[{id(self)}] daemon: {line.strip()[:180]}")
+                kind = words[0]
+                if kind == 'question':
+                    self.sid = words[1]
+                    dims = [int(d) for d in words[3].split(',')]
+                    self._render_question(int(words[2]), dims, self._options(words[4:]))
+                elif kind == 'done':
+                    dims = [int(d) for d in words[2].split(',')] if len(words) > 2 else []
+                    self._render_done(dims, self._options(words[3:]))
+                    break
+                elif kind == 'failed':
+                    self.output_lines.append(' '.join(words[2:]))
+                    break
+                elif kind == 'error':
+                    # a rejected answer leaves the question pending; anything else ends the session
+                    self.output_lines.append('Error: ' + ' '.join(words[2:]))
+                    if self.sid is None or words[1] != self.sid:
+                        break
+                else:
+                    break
+        except Exception as e:
+            dlog(f"[{id(self)}] read error: {e}")
+        dlog(f"[{id(self)}] daemon session ended sid={self.sid}")
+        self.is_running = False
+        self._close(sock)
+
+    def _close(self, sock):
+        try:
+            sock.shutdown(socket.SHUT_RDWR)
+        except OSError:
+            pass
+        sock.close()
+
+    def send_input(self, user_input):
+        """Answer the pending question of the session"""
+        if self.sock and self.is_running and self.sid is not None:
+            dlog(f"[{id(self)}] in: {user_input}")
+            return self._send(f"answer {self.sid} {user_input}")
+        return False
+
+    def stop_algorithm(self):
+        """Close the connection, which releases the session in the daemon"""
+        self.is_running = False
+        if self.sock:
+            self._close(self.sock)
+            self.sock = None
+
 class UHAlgorithmRunner:
     def __init__(self):
         self.process = None
@@ -264,16 +535,13 @@ class UHAlgorithmRunner:
     def start_algorithm(self, attributes):
         """Start the UH-Random C++ algorithm process"""
         try:
-            # Ensure output directory exists for C++ intermediate files
-            os.makedirs('output', exist_ok=True)
-            
             # Build UH-Random binary if it doesn't exist
             if not os.path.exists('./main_uh_random'):
                 print("Building UH-Random algorithm...")
                 result = subprocess.run([
                     "clang++", "-w", "-I/opt/local/include", "--std=c++17", "-Wall", "-Werror", "-pedantic",
                     "main_uh_random.cpp", "highdim.cpp", "attribute_subset.cpp", "util.cpp",
-                    "other/*.c", "other/*.cpp", "-L/opt/local/lib", "-lglpk", "-lm", "-Ofast", "-o", "main_uh_random"
+                    "other/*.c", "other/*.cpp", "-L/opt/local/lib", "-lglpk", "-lm", "-pthread", "-Ofast", "-o", "main_uh_random"
                 ], capture_output=True, text=True)
                 if result.returncode != 0:
                     return False, f"Build failed: {result.stderr}"
@@ -286,7 +554,7 @@ class UHAlgorithmRunner:
             
             # Start the UH-Random algorithm process
             self.process = subprocess.Popen(
-                ["./main_uh_random", "car.txt"],
+                ["./main_uh_random", dataset_file()],
                 stdin=subprocess.PIPE,
                 stdout=subprocess.PIPE,
                 stderr=subprocess.STDOUT,
@@ -439,7 +707,7 @@ def start_algorithm():
     session_id = data.get('session_id')
     if not session_id:
         return jsonify({'success': False, 'message': 'session_id is required'}), 400
-    dataset = 'car.txt'  # Always use car.txt at repo root
+    dataset = dataset_file()
     use_real = data.get('use_real', False)
 
     dlog(f"/start_algorithm session={session_id} use_real={use_real}")